@@ -0,0 +1,430 @@
+/* bench.c - benchmark harness
+ *
+ * bench_run times a workload several times on the wall clock (monotonic)
+ * and on the process CPU clock, after untimed warmup runs, with the calling
+ * thread pinned to one CPU so that migrations do not show up as noise. The
+ * results carry median, p10/p90, mean, stddev and min of the wall times, and
+ * the throughput in MB/s and records/s at the median. On Linux the timed runs
+ * can also be wrapped in perf_event_open counters (cycles, instructions,
+ * branch and cache misses); where they cannot be opened the results simply
+ * carry none and say why.
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE    /* sched_setaffinity, sched_getcpu */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "bench.h"
+
+/* Wall-clock seconds from a monotonic clock. clock() only counts CPU time,
+   which hides the time spent waiting for the file to be read. */
+double bench_wall_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+/* CPU time of the whole process, user + system, all threads */
+double bench_cpu_seconds(void) {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#elif defined(CLOCK_PROCESS_CPUTIME_ID)
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* ============== CPU pinning ============== */
+
+typedef struct {
+#ifdef _WIN32
+    DWORD_PTR mask;
+#elif defined(__linux__)
+    cpu_set_t mask;
+#endif
+    BOOL pinned;
+} Affinity;
+
+/* Pins the calling thread as cfg->cpu asks and remembers the previous
+   affinity in *saved. Returns the CPU, or -1 when not pinned */
+static int pinThread(int cpu, Affinity *saved) {
+    saved->pinned = FALSE;
+    if (cpu == BENCH_NO_PIN) return -1;
+#ifdef _WIN32
+    if (cpu == BENCH_CPU_CURRENT) cpu = (int)GetCurrentProcessorNumber();
+    if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8)) return -1;
+    saved->mask = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+    if (!saved->mask) return -1;
+    saved->pinned = TRUE;
+    return cpu;
+#elif defined(__linux__)
+    if (cpu == BENCH_CPU_CURRENT) cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+    if (sched_getaffinity(0, sizeof(saved->mask), &saved->mask) != 0) return -1;
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    if (sched_setaffinity(0, sizeof(one), &one) != 0) return -1;
+    saved->pinned = TRUE;
+    return cpu;
+#else
+    /* no thread affinity API (macOS): run unpinned */
+    return -1;
+#endif
+}
+
+static void unpinThread(const Affinity *saved) {
+    if (!saved->pinned) return;
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), saved->mask);
+#elif defined(__linux__)
+    sched_setaffinity(0, sizeof(saved->mask), &saved->mask);
+#endif
+}
+
+/* ============== Hardware counters ============== */
+
+static const char *const counterNames[BENCH_COUNTERS] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"
+};
+
+const char *bench_counter_name(int counter) {
+    return (counter >= 0 && counter < BENCH_COUNTERS) ? counterNames[counter] : "?";
+}
+
+typedef struct {
+    int fd[BENCH_COUNTERS];     /* -1 when the counter is not open */
+} Counters;
+
+#ifdef __linux__
+#define HW_CACHE(cache, op, result) \
+    ((cache) | ((op) << 8) | ((result) << 16))
+
+static const struct {
+    unsigned type;
+    unsigned long long config;
+} counterEvents[BENCH_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, HW_CACHE(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                   PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+};
+#endif
+
+/* Opens every counter, disabled, for the calling thread and the threads it
+   creates. Returns the errno of the first one that could not be opened, or
+   0; the others stay usable */
+static int openCounters(Counters *c) {
+    int err = 0;
+    for (int i = 0; i < BENCH_COUNTERS; ++i) {
+        c->fd[i] = -1;
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counterEvents[i].type;
+        attr.config = counterEvents[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        c->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (c->fd[i] < 0 && !err) err = errno;
+#else
+        err = ENOSYS;
+#endif
+    }
+    return err;
+}
+
+/* Counts only while enabled: around each timed run, not the setup */
+static void enableCounters(Counters *c, BOOL on) {
+#ifdef __linux__
+    for (int i = 0; i < BENCH_COUNTERS; ++i)
+        if (c->fd[i] >= 0)
+            ioctl(c->fd[i], on ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+#else
+    (void)c; (void)on;
+#endif
+}
+
+/* Closes the counters, storing their totals divided by 'runs' in out.
+   When the PMU had more events than registers the kernel multiplexed
+   them, and the counts are scaled up to the enabled time */
+static void closeCounters(Counters *c, int runs, BenchResult *out) {
+#ifdef __linux__
+    for (int i = 0; i < BENCH_COUNTERS; ++i) {
+        if (c->fd[i] < 0) continue;
+        unsigned long long v[3];    /* value, time enabled, time running */
+        if (read(c->fd[i], v, sizeof(v)) == (ssize_t)sizeof(v) && v[2] > 0) {
+            double value = (double)v[0];
+            if (v[2] < v[1]) value *= (double)v[1] / (double)v[2];
+            out->counters[i] = value / runs;
+            out->counters_valid |= 1u << i;
+        }
+        close(c->fd[i]);
+        c->fd[i] = -1;
+    }
+#else
+    (void)c; (void)runs; (void)out;
+#endif
+}
+
+/* ============== Runs and statistics ============== */
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentile q (0..1) of sorted[0 .. n), interpolating between ranks */
+static double percentile(const double *sorted, int n, double q) {
+    double pos = q * (double)(n - 1);
+    int lo = (int)pos;
+    if (lo >= n - 1) return sorted[n - 1];
+    return sorted[lo] + (sorted[lo + 1] - sorted[lo]) * (pos - (double)lo);
+}
+
+void bench_run(const BenchConfig *cfg, const char *name, size_t bytes,
+               BenchFn fn, void *ctx, BenchResult *out) {
+    static const BenchConfig defaults = BENCH_DEFAULT_CONFIG;
+    if (!cfg) cfg = &defaults;
+    int reps = cfg->repetitions;
+    if (reps < 1) reps = 1;
+    if (reps > BENCH_MAX_REPETITIONS) reps = BENCH_MAX_REPETITIONS;
+
+    memset(out, 0, sizeof(*out));
+    snprintf(out->name, sizeof(out->name), "%s", name);
+    out->bytes = bytes;
+
+    Affinity saved;
+    out->cpu = pinThread(cfg->cpu, &saved);
+    for (int i = 0; i < cfg->warmup; ++i) {
+        if (cfg->setup) cfg->setup(ctx);
+        fn(ctx);
+    }
+
+    Counters counters;
+    if (cfg->counters)
+        out->counters_error = openCounters(&counters);
+    double wall[BENCH_MAX_REPETITIONS], cpu[BENCH_MAX_REPETITIONS];
+    for (int i = 0; i < reps; ++i) {
+        if (cfg->setup) cfg->setup(ctx);
+        if (cfg->counters) enableCounters(&counters, TRUE);
+        double c0 = bench_cpu_seconds();
+        double w0 = bench_wall_seconds();
+        out->records = fn(ctx);
+        wall[i] = bench_wall_seconds() - w0;
+        cpu[i] = bench_cpu_seconds() - c0;
+        if (cfg->counters) enableCounters(&counters, FALSE);
+    }
+    if (cfg->counters)
+        closeCounters(&counters, reps, out);
+    unpinThread(&saved);
+
+    double sum = 0.0;
+    for (int i = 0; i < reps; ++i) sum += wall[i];
+    double mean = sum / reps;
+    double var = 0.0;
+    for (int i = 0; i < reps; ++i) var += (wall[i] - mean) * (wall[i] - mean);
+
+    qsort(wall, (size_t)reps, sizeof(double), compareDouble);
+    qsort(cpu, (size_t)reps, sizeof(double), compareDouble);
+    out->runs = reps;
+    out->wall_median = percentile(wall, reps, 0.5);
+    out->wall_p10 = percentile(wall, reps, 0.1);
+    out->wall_p90 = percentile(wall, reps, 0.9);
+    out->wall_mean = mean;
+    out->wall_stddev = (reps > 1) ? sqrt(var / (reps - 1)) : 0.0;
+    out->wall_min = wall[0];
+    out->cpu_median = percentile(cpu, reps, 0.5);
+    if (out->wall_median > 0.0) {
+        out->mb_per_s = (double)bytes / (1024.0 * 1024.0) / out->wall_median;
+        out->records_per_s = (double)out->records / out->wall_median;
+    }
+}
+
+/* ============== Output ============== */
+
+void bench_print_table(FILE *out, const BenchResult *results, int count) {
+    fprintf(out, "%-24s %10s %10s %10s %10s %10s %10s %12s %8s\n",
+            "method", "median s", "p10 s", "p90 s", "stddev s", "cpu s",
+            "MB/s", "record/s", "usec/rec");
+    for (int i = 0; i < count; ++i) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "%-24s %10.4f %10.4f %10.4f %10.4f %10.4f %10.1f %12.0f %8.3f\n",
+                r->name, r->wall_median, r->wall_p10, r->wall_p90, r->wall_stddev,
+                r->cpu_median, r->mb_per_s, r->records_per_s,
+                r->records ? r->wall_median * 1e6 / (double)r->records : 0.0);
+    }
+}
+
+/* Writes s as a JSON string */
+static void jsonString(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+void bench_print_json(FILE *out, const BenchResult *results, int count) {
+    fprintf(out, "{\n  \"results\": [");
+    for (int i = 0; i < count; ++i) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "%s\n    {\"name\": ", i ? "," : "");
+        jsonString(out, r->name);
+        fprintf(out, ", \"runs\": %d, \"cpu\": %d, \"records\": %lu, \"bytes\": %zu,"
+                     " \"wall_median\": %.6f, \"wall_p10\": %.6f, \"wall_p90\": %.6f,"
+                     " \"wall_mean\": %.6f, \"wall_stddev\": %.6f, \"wall_min\": %.6f,"
+                     " \"cpu_median\": %.6f, \"mb_per_s\": %.3f, \"records_per_s\": %.1f",
+                r->runs, r->cpu, r->records, r->bytes,
+                r->wall_median, r->wall_p10, r->wall_p90,
+                r->wall_mean, r->wall_stddev, r->wall_min,
+                r->cpu_median, r->mb_per_s, r->records_per_s);
+        if (r->counters_valid) {
+            fprintf(out, ", \"counters\": {");
+            const char *sep = "";
+            for (int k = 0; k < BENCH_COUNTERS; ++k) {
+                if (!(r->counters_valid & (1u << k))) continue;
+                double v = r->counters[k];
+                fprintf(out, "%s\"%s\": {\"per_run\": %.0f, \"per_record\": %.4f, \"per_byte\": %.6f}",
+                        sep, counterNames[k], v,
+                        r->records ? v / (double)r->records : 0.0,
+                        r->bytes ? v / (double)r->bytes : 0.0);
+                sep = ", ";
+            }
+            fprintf(out, "}");
+        }
+        else if (r->counters_error) {
+            fprintf(out, ", \"counters_error\": ");
+            jsonString(out, strerror(r->counters_error));
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+void bench_print_csv(FILE *out, const BenchResult *results, int count) {
+    fprintf(out, "name,runs,cpu,records,bytes,wall_median,wall_p10,wall_p90,"
+                 "wall_mean,wall_stddev,wall_min,cpu_median,mb_per_s,records_per_s");
+    for (int k = 0; k < BENCH_COUNTERS; ++k)
+        fprintf(out, ",%s_per_record", counterNames[k]);
+    for (int k = 0; k < BENCH_COUNTERS; ++k)
+        fprintf(out, ",%s_per_byte", counterNames[k]);
+    fprintf(out, "\n");
+    for (int i = 0; i < count; ++i) {
+        const BenchResult *r = &results[i];
+        /* quoted, with quotes doubled: method names contain no newlines */
+        fputc('"', out);
+        for (const char *s = r->name; *s; ++s) {
+            if (*s == '"') fputc('"', out);
+            fputc(*s, out);
+        }
+        fprintf(out, "\",%d,%d,%lu,%zu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%.1f",
+                r->runs, r->cpu, r->records, r->bytes,
+                r->wall_median, r->wall_p10, r->wall_p90,
+                r->wall_mean, r->wall_stddev, r->wall_min,
+                r->cpu_median, r->mb_per_s, r->records_per_s);
+        for (int k = 0; k < BENCH_COUNTERS; ++k) {
+            if ((r->counters_valid & (1u << k)) && r->records)
+                fprintf(out, ",%.4f", r->counters[k] / (double)r->records);
+            else
+                fputc(',', out);
+        }
+        for (int k = 0; k < BENCH_COUNTERS; ++k) {
+            if ((r->counters_valid & (1u << k)) && r->bytes)
+                fprintf(out, ",%.6f", r->counters[k] / (double)r->bytes);
+            else
+                fputc(',', out);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/* Prints counter k of r divided by 'per', or '-' if it was not read */
+static void counterCell(FILE *out, const BenchResult *r, int k, double per, int width) {
+    if ((r->counters_valid & (1u << k)) && per > 0.0)
+        fprintf(out, " %*.3f", width, r->counters[k] / per);
+    else
+        fprintf(out, " %*s", width, "-");
+}
+
+void bench_print_counters(FILE *out, const BenchResult *results, int count) {
+    unsigned any = 0;
+    int err = 0;
+    for (int i = 0; i < count; ++i) {
+        any |= results[i].counters_valid;
+        if (!err) err = results[i].counters_error;
+    }
+    if (!any) {
+        fprintf(out, "hardware counters unavailable (%s)\n",
+                err ? strerror(err) : "not requested");
+        return;
+    }
+    if (err)
+        fprintf(out, "some hardware counters unavailable (%s)\n", strerror(err));
+    fprintf(out, "%-24s %10s %10s %6s %10s %10s %10s %10s %10s\n",
+            "per record", "cycles", "instr", "IPC", "br-miss", "L1d-miss",
+            "LLC-miss", "cycles/B", "instr/B");
+    for (int i = 0; i < count; ++i) {
+        const BenchResult *r = &results[i];
+        double recs = (double)r->records, bytes = (double)r->bytes;
+        fprintf(out, "%-24s", r->name);
+        counterCell(out, r, BENCH_CYCLES, recs, 10);
+        counterCell(out, r, BENCH_INSTRUCTIONS, recs, 10);
+        unsigned ipc = (1u << BENCH_CYCLES) | (1u << BENCH_INSTRUCTIONS);
+        if ((r->counters_valid & ipc) == ipc && r->counters[BENCH_CYCLES] > 0.0)
+            fprintf(out, " %6.2f", r->counters[BENCH_INSTRUCTIONS] / r->counters[BENCH_CYCLES]);
+        else
+            fprintf(out, " %6s", "-");
+        counterCell(out, r, BENCH_BRANCH_MISSES, recs, 10);
+        counterCell(out, r, BENCH_L1D_MISSES, recs, 10);
+        counterCell(out, r, BENCH_LLC_MISSES, recs, 10);
+        counterCell(out, r, BENCH_CYCLES, bytes, 10);
+        counterCell(out, r, BENCH_INSTRUCTIONS, bytes, 10);
+        fprintf(out, "\n");
+    }
+}
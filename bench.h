@@ -0,0 +1,89 @@
+/* bench.h - benchmark harness: repeated wall/CPU timing with statistics, see bench.c */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "fscanfasta.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* BenchConfig.cpu: pin to the CPU the thread is on when bench_run starts,
+   or do not pin at all; any other value >= 0 is a CPU number */
+#define BENCH_CPU_CURRENT (-1)
+#define BENCH_NO_PIN      (-2)
+
+typedef struct {
+    int warmup;         /* untimed runs before the measured ones */
+    int repetitions;    /* measured runs, at most BENCH_MAX_REPETITIONS */
+    int cpu;            /* CPU to pin the calling thread to while it runs */
+    BOOL counters;      /* also read the hardware counters (BENCH_CYCLES ...) */
+    void (*setup)(void *ctx);   /* untimed, before every run; NULL for none */
+} BenchConfig;
+
+#define BENCH_MAX_REPETITIONS 1000
+#define BENCH_DEFAULT_CONFIG { 1, 5, BENCH_CPU_CURRENT, FALSE, NULL }
+
+/* Hardware counters, counted in user space over the timed runs through
+   perf_event_open (Linux only). Any counter the CPU, the kernel or the
+   perf_event_paranoid setting does not allow is left out of the result */
+enum {
+    BENCH_CYCLES,
+    BENCH_INSTRUCTIONS,
+    BENCH_BRANCH_MISSES,
+    BENCH_L1D_MISSES,       /* L1 data cache read misses */
+    BENCH_LLC_MISSES,       /* last level cache misses */
+    BENCH_COUNTERS
+};
+
+/* Statistics of the measured runs of one workload; times in seconds */
+typedef struct {
+    char name[64];
+    int runs;
+    int cpu;                    /* CPU it was pinned to, -1 if not pinned */
+    unsigned long records;      /* returned by the last run */
+    size_t bytes;               /* input size, for MB/s */
+    double wall_median, wall_p10, wall_p90;
+    double wall_mean, wall_stddev, wall_min;
+    double cpu_median;          /* process CPU time (all threads) */
+    double mb_per_s;            /* bytes / wall_median */
+    double records_per_s;       /* records / wall_median */
+    unsigned counters_valid;    /* bit i set when counter i was read */
+    int counters_error;         /* errno of the first counter that failed, 0 if none */
+    double counters[BENCH_COUNTERS]; /* mean per timed run */
+} BenchResult;
+
+/* One run of the workload; returns the number of records it parsed */
+typedef unsigned long (*BenchFn)(void *ctx);
+
+/* Monotonic wall clock and process CPU time, in seconds */
+double bench_wall_seconds(void);
+double bench_cpu_seconds(void);
+
+/* Runs fn cfg->warmup times untimed, then cfg->repetitions times timed
+   (pinned as cfg->cpu asks, the affinity is restored afterwards), and
+   fills *out. 'bytes' is the input size the MB/s figure refers to */
+void bench_run(const BenchConfig *cfg, const char *name, size_t bytes,
+               BenchFn fn, void *ctx, BenchResult *out);
+
+/* Short name of counter i, as used in the JSON output ("cycles", ...) */
+const char *bench_counter_name(int counter);
+
+/* Human-readable table, a JSON document {"results": [...]} with one
+   object per result, and CSV with a header line and one row per result
+   (counters per record and per byte, empty when not read) */
+void bench_print_table(FILE *out, const BenchResult *results, int count);
+void bench_print_json(FILE *out, const BenchResult *results, int count);
+void bench_print_csv(FILE *out, const BenchResult *results, int count);
+
+/* Counters per record and per byte, or a line saying why there are none */
+void bench_print_counters(FILE *out, const BenchResult *results, int count);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* BENCH_H */
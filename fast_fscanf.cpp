@@ -1,11 +1,14 @@
 // fast_fscanf.cpp
 #include <cstdio>
 #include <cstdarg>
-#include <charconv>   // for std::from_chars on integrals (C++17) & float/double (C++20)
 #include <cerrno>
 #include <cstring>
 #include <cstdlib>
-#include <cctype>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "fast_fscanf.h"
 
 /**
  * A memory-based "fast_fscanf" that reads from a (char* buffer, size_t size)
@@ -14,10 +17,14 @@
  *   %hd, %hu, %d, %u, %ld, %lu, %x, %hx, %lx
  *   %f, %lf, %Lf
  *   %c, %s
+ *   %S  (like %s, but fills an FfsStringView that points into the buffer:
+ *        no copy, no terminator, no length limit but the width)
+ *
+ * "%*d" etc. (assignment suppression) pass over the field with a cheap
+ * character-class scan and no conversion: no argument, not counted.
  *
  * Limitations:
- *  - No field width (e.g. "%3d") except for strings (%s) – see code below.
- *  - No assignment-suppression (e.g. "%*d").
+ *  - No field width (e.g. "%3d") except for strings (%s, %S) – see code below.
  *  - No octal parsing (%o).
  *  - We handle literal punctuation vs numeric token boundaries in a single pass,
  *    so e.g. ":%x[%hd](" should parse as intended without extra spaces.
@@ -25,7 +32,8 @@
 
 /**
  * fast_fscanf_mem:
- *   - buffer, size: the memory block holding the entire text file
+ *   - buffer, size: the memory block holding the entire text file, followed
+ *     by FFS_PADDING readable bytes (see ffs_kernels.h)
  *   - offset: [in/out] current parsing index within that buffer
  *   - format: the scanf-like format string
  *   - ...: pointers to the variables to fill
@@ -48,213 +56,48 @@
 // INTERNALS BELOW
 // -------------------------------------------------------------------------
 
-// We'll use a lightweight "scanner" struct to walk the buffer by pointer:
-struct MemScanner {
-    const char *ptr;   // current position
-    const char *end;   // one-past the last valid character
-};
-
-/** Returns true if we're out of data. */
-static inline bool ms_eof(const MemScanner &ms)
-{
-    return (ms.ptr >= ms.end);
-}
-
-/** Peek a character (0 if EOF). */
-static inline char ms_peek(const MemScanner &ms)
-{
-    return ms_eof(ms) ? '\0' : *ms.ptr;
-}
-
-/** Advance one char; return it, or 0 if EOF. */
-static inline char ms_getc(MemScanner &ms)
-{
-    if (ms_eof(ms)) return '\0';
-    return *ms.ptr++;
-}
-
-/** "Ungetc" by moving back 1 char (if not at start). */
-static inline void ms_ungetc(MemScanner &ms)
-{
-    // We'll just move ptr back by 1 if possible
-    if (ms.ptr > ms.end) {
-        // If we were out of range, clamp
-        ms.ptr = ms.end;
-    }
-    if (ms.ptr > (ms.end - (ms.end - ms.ptr)) ) {
-        // basically do: if (we're not at the beginning) go back
-        ms.ptr--;
-    }
-}
-
-/** Skip whitespace. */
-static void ms_skip_whitespace(MemScanner &ms)
-{
-    while (!ms_eof(ms) && isspace((unsigned char)*ms.ptr)) {
-        ms.ptr++;
-    }
-}
+// The scanner primitives and typed conversions live in fast_fscanf.h, where
+// the fscanfasta::scan template front-end can inline them.
+using namespace fscanfasta::detail;
 
 // -------------------------------------------------------------------------
-// readChar: for '%c' – read exactly 1 char, even if it's whitespace.
+// scanConversion: perform one decoded conversion and store it through the
+// next pointer in 'args'. Returns false on mismatch.
 // -------------------------------------------------------------------------
-static bool readChar(MemScanner &ms, char &out)
+static bool scanConversion(MemScanner &ms, const FfsOp &op, va_list *args)
 {
-    if (ms_eof(ms)) {
+    switch (op.conv)
+    {
+    case CONV_SHORT:      return scanSigned(ms, *va_arg(*args, short*));
+    case CONV_INT:        return scanSigned(ms, *va_arg(*args, int*));
+    case CONV_LONG:       return scanSigned(ms, *va_arg(*args, long*));
+    case CONV_USHORT:     return scanUnsigned<10>(ms, *va_arg(*args, unsigned short*));
+    case CONV_UINT:       return scanUnsigned<10>(ms, *va_arg(*args, unsigned int*));
+    case CONV_ULONG:      return scanUnsigned<10>(ms, *va_arg(*args, unsigned long*));
+    case CONV_HEX_USHORT: return scanUnsigned<16>(ms, *va_arg(*args, unsigned short*));
+    case CONV_HEX_UINT:   return scanUnsigned<16>(ms, *va_arg(*args, unsigned int*));
+    case CONV_HEX_ULONG:  return scanUnsigned<16>(ms, *va_arg(*args, unsigned long*));
+    case CONV_FLOAT:      return scanFloat(ms, *va_arg(*args, float*));
+    case CONV_DOUBLE:     return scanFloat(ms, *va_arg(*args, double*));
+    case CONV_LDOUBLE:    return scanFloat(ms, *va_arg(*args, long double*));
+
+    case CONV_CHAR:
+        // read exactly one char
+        return readChar(ms, *va_arg(*args, char*));
+
+    case CONV_STRING:
+        // read a string up to whitespace; the width counts characters, the
+        // buffer needs one more for the terminator (scanf semantics)
+        return readString(ms, va_arg(*args, char*),
+                          (op.width > 0 ? op.width + 1 : 1024));
+
+    case CONV_VIEW:
+        return readView(ms, *va_arg(*args, FfsStringView*), op.width);
+
+    default:
+        // unsupported -> do nothing
         return false;
     }
-    out = ms_getc(ms);
-    return true;
-}
-
-// -------------------------------------------------------------------------
-// readString: for '%s' – skip leading whitespace, then read until next space
-// or punctuation. Actually, real scanf stops at whitespace for "%s". We'll do
-// the same. If you want punctuation-based stop for strings, you'd do something else.
-//
-// width > 0 => maximum length (minus 1 for null terminator).
-// Returns true if we got at least 1 char.
-// -------------------------------------------------------------------------
-static bool readString(MemScanner &ms, char *dest, int width)
-{
-    if (!dest) return false;
-    if (width <= 0) {
-        // treat 0 or negative as "some big limit"
-        width = 1024 * 1024;
-    }
-
-    ms_skip_whitespace(ms);
-
-    int count = 0;
-    while (!ms_eof(ms)) {
-        char c = ms_peek(ms);
-        if (isspace((unsigned char)c)) {
-            // stop
-            break;
-        }
-        // read it
-        ms_getc(ms);
-        if (count < (width - 1)) {
-            dest[count++] = c;
-            dest[count] = '\0';
-        }
-    }
-    return (count > 0);
-}
-
-// -------------------------------------------------------------------------
-// readIntegerToken: gather sign if base=10, gather digits for base 10 or 16,
-// stop at first non-digit. Then ungetc that char. Return false if no digit.
-// -------------------------------------------------------------------------
-static bool readIntegerToken(MemScanner &ms, bool allowSign, int base,
-                             char *outBuf, size_t bufSize)
-{
-    if (!outBuf || bufSize < 2) return false;
-    ms_skip_whitespace(ms);
-
-    size_t pos = 0;
-    outBuf[0] = '\0';
-
-    // optional sign?
-    if (allowSign) {
-        char c = ms_peek(ms);
-        if (c == '+' || c == '-') {
-            ms_getc(ms); // consume
-            outBuf[pos++] = c;
-            outBuf[pos]   = '\0';
-        }
-    }
-
-    bool gotDigit = false;
-    while (!ms_eof(ms)) {
-        char c = ms_peek(ms);
-
-        bool valid = false;
-        if (base == 10) {
-            valid = isdigit((unsigned char)c);
-        } else if (base == 16) {
-            valid = isxdigit((unsigned char)c);
-        }
-
-        if (!valid) {
-            break;
-        }
-        // consume it
-        ms_getc(ms);
-        if (pos < bufSize - 1) {
-            outBuf[pos++] = c;
-            outBuf[pos]   = '\0';
-        }
-        gotDigit = true;
-    }
-    return gotDigit;
-}
-
-// -------------------------------------------------------------------------
-// readFloatToken: gather sign, digits, one decimal point, exponent, etc.
-// Stop at first character that isn't valid in a float (like punctuation).
-// Then ungetc if needed. Return false if we didn't read anything numeric.
-// -------------------------------------------------------------------------
-static bool readFloatToken(MemScanner &ms, char *outBuf, size_t bufSize)
-{
-    if (!outBuf || bufSize < 2) return false;
-    ms_skip_whitespace(ms);
-
-    // We'll do a naive approach: accept sign, digits, a single '.', 'e/E' and
-    // optional exponent sign. This won't be bulletproof (e.g. multiple '.'?), but
-    // good enough for most input that is well-formed like "123.456e-2".
-    size_t pos = 0;
-    outBuf[0]  = '\0';
-    bool gotAny = false;
-    bool seenExponent = false;
-    bool seenDot = false;
-
-    // optional leading sign
-    char c = ms_peek(ms);
-    if (c == '+' || c == '-') {
-        ms_getc(ms);
-        outBuf[pos++] = c;
-        outBuf[pos]   = '\0';
-        gotAny = true;
-    }
-
-    while (!ms_eof(ms)) {
-        c = ms_peek(ms);
-
-        bool valid = false;
-
-        if (isdigit((unsigned char)c)) {
-            valid = true;
-            gotAny = true;
-        } else if (!seenDot && c == '.') {
-            seenDot = true;
-            valid   = true;
-            gotAny  = true;
-        } else if (!seenExponent && (c == 'e' || c == 'E')) {
-            seenExponent = true;
-            valid        = true;
-            gotAny       = true;
-        } else if ((c == '+' || c == '-') && seenExponent) {
-            // sign after 'e' or 'E' is allowed if it's the immediate next char
-            // so let's check previous char in outBuf if we can
-            if (pos > 0 && (outBuf[pos-1] == 'e' || outBuf[pos-1] == 'E')) {
-                valid  = true;
-                gotAny = true;
-            }
-        }
-
-        if (!valid) {
-            break;
-        }
-        // consume it
-        ms_getc(ms);
-        if (pos < bufSize - 1) {
-            outBuf[pos++] = c;
-            outBuf[pos]   = '\0';
-        }
-    }
-
-    return gotAny;
 }
 
 // -------------------------------------------------------------------------
@@ -281,226 +124,23 @@ int fast_fscanf_mem(
             // we have a conversion specifier
             format++;
 
-            // skip optional '.' or digits in the format (like "%.2f" or "%3d")
-            while (*format == '.' || isdigit((unsigned char)*format)) {
-                format++;
-            }
-
-            // check length modifiers
-            bool isShort      = false;  // 'h'
-            bool isLong       = false;  // 'l'
-            bool isLongDouble = false;  // 'L'
-
-            if (*format == 'h') {
-                isShort = true;
-                format++;
-            } else if (*format == 'l') {
-                isLong = true;
-                format++;
-            } else if (*format == 'L') {
-                isLongDouble = true;
-                format++;
-            }
-
-            // Possibly read a width for "%s" (like "%63s")
-            int strWidth = 0;
-            if (isdigit((unsigned char)*format)) {
-                // gather the digits
-                char widthStr[16] = {0};
-                int wi = 0;
-                while (isdigit((unsigned char)*format) && wi < 15) {
-                    widthStr[wi++] = *format++;
-                }
-                widthStr[wi] = '\0';
-                strWidth = atoi(widthStr);
-            }
-
-            char spec = *format;
-            if (spec == '\0') {
-                // format ended abruptly
+            FfsOp op;
+            if (!decodeConversion(format, op)) {
                 break;
             }
-            format++;
-
-            bool success = false;
-
-            switch (spec)
-            {
-            case 'd': {
-                // decimal integer
-                char tok[128] = {0};
-                if (readIntegerToken(ms, true /*allowSign*/, 10, tok, sizeof(tok))) {
-                    // parse with from_chars or strtol
-                    if (isShort) {
-                        short *p = va_arg(args, short*);
-                        long val = 0;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), val, 10);
-                        if (r.ec == std::errc()) {
-                            *p = (short)val;
-                            success = true;
-                        }
-                    } else if (isLong) {
-                        long *p = va_arg(args, long*);
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), *p, 10);
-                        if (r.ec == std::errc()) {
-                            success = true;
-                        }
-                    } else {
-                        int *p = va_arg(args, int*);
-                        long val = 0;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), val, 10);
-                        if (r.ec == std::errc()) {
-                            *p = (int)val;
-                            success = true;
-                        }
-                    }
-                }
-            } break;
-
-            case 'u': {
-                // unsigned decimal
-                char tok[128] = {0};
-                if (readIntegerToken(ms, false/*no sign*/, 10, tok, sizeof(tok))) {
-                    if (isShort) {
-                        unsigned short *p = va_arg(args, unsigned short*);
-                        unsigned long val = 0;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), val, 10);
-                        if (r.ec == std::errc()) {
-                            *p = (unsigned short)val;
-                            success = true;
-                        }
-                    } else if (isLong) {
-                        unsigned long *p = va_arg(args, unsigned long*);
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), *p, 10);
-                        if (r.ec == std::errc()) {
-                            success = true;
-                        }
-                    } else {
-                        unsigned int *p = va_arg(args, unsigned int*);
-                        unsigned long val = 0;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), val, 10);
-                        if (r.ec == std::errc()) {
-                            *p = (unsigned int)val;
-                            success = true;
-                        }
-                    }
-                }
-            } break;
-
-            case 'x': {
-                // hex integer
-                char tok[128] = {0};
-                if (readIntegerToken(ms, false/*no sign*/, 16, tok, sizeof(tok))) {
-                    if (isShort) {
-                        unsigned short *p = va_arg(args, unsigned short*);
-                        unsigned long val = 0;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), val, 16);
-                        if (r.ec == std::errc()) {
-                            *p = (unsigned short)val;
-                            success = true;
-                        }
-                    } else if (isLong) {
-                        unsigned long *p = va_arg(args, unsigned long*);
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), *p, 16);
-                        if (r.ec == std::errc()) {
-                            success = true;
-                        }
-                    } else {
-                        unsigned int *p = va_arg(args, unsigned int*);
-                        unsigned long val = 0;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok), val, 16);
-                        if (r.ec == std::errc()) {
-                            *p = (unsigned int)val;
-                            success = true;
-                        }
-                    }
-                }
-            } break;
-
-            case 'f':
-            case 'g':
-            case 'e': {
-                // float / double parse
-                char tok[256] = {0};
-                if (readFloatToken(ms, tok, sizeof(tok))) {
-                    if (isLongDouble) {
-                        long double *p = va_arg(args, long double*);
-                        // from_chars for long double isn't fully standard yet, fallback:
-                        char *endp = nullptr;
-                        long double val = strtold(tok, &endp);
-                        if (endp != tok) {
-                            *p = val;
-                            success = true;
-                        }
-                    } else if (isLong) {
-                        double *p = va_arg(args, double*);
-                        // some C++ libs do partial from_chars for double:
-                        double tmp;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok),
-                                                 tmp, std::chars_format::general);
-                        if (r.ec == std::errc()) {
-                            *p = tmp;
-                            success = true;
-                        } else {
-                            // fallback
-                            char *endp = nullptr;
-                            double val = strtod(tok, &endp);
-                            if (endp != tok) {
-                                *p = val;
-                                success = true;
-                            }
-                        }
-                    } else {
-                        float *p = va_arg(args, float*);
-                        // parse as double then cast
-                        double tmp;
-                        auto r = std::from_chars(tok, tok + std::strlen(tok),
-                                                 tmp, std::chars_format::general);
-                        if (r.ec == std::errc()) {
-                            *p = (float)tmp;
-                            success = true;
-                        } else {
-                            // fallback
-                            char *endp = nullptr;
-                            double val = strtod(tok, &endp);
-                            if (endp != tok) {
-                                *p = (float)val;
-                                success = true;
-                            }
-                        }
-                    }
-                }
-            } break;
 
-            case 'c': {
-                // read exactly one char
-                char *p = va_arg(args, char*);
-                if (readChar(ms, *p)) {
-                    success = true;
-                }
-            } break;
-
-            case 's': {
-                // read a string up to whitespace
-                char *p = va_arg(args, char*);
-                if (readString(ms, p, (strWidth > 0 ? strWidth : 1024))) {
-                    success = true;
+            if (op.suppress && op.conv != CONV_UNSUPPORTED) {
+                if (!skipField(ms, op.conv)) {
+                    break;
                 }
-            } break;
-
-            default:
-                // unsupported -> do nothing
-                break;
-            }
-
-            if (success) {
+            } else if (scanConversion(ms, op, &args)) {
                 matchedCount++;
             } else {
                 // partial or no match, so stop
                 break;
             }
         }
-        else if (isspace((unsigned char)*format)) {
+        else if (ffs_is_space(*format)) {
             // skip whitespace in format
             ms_skip_whitespace(ms);
             format++;
@@ -515,7 +155,7 @@ int fast_fscanf_mem(
                 if (c == '\n') {
                     break;
                 }
-                if (!isspace((unsigned char)c)) {
+                if (!ffs_is_space(c)) {
                     // mismatch
                     ms_ungetc(ms);
                     break;
@@ -524,19 +164,7 @@ int fast_fscanf_mem(
         }
         else {
             // literal character
-            // skip whitespace in the input before matching a literal
-            ms_skip_whitespace(ms);
-
-            char expected = *format++;
-            // read one char from input
-            if (ms_eof(ms)) {
-                // can't match
-                break;
-            }
-            char c = ms_getc(ms);
-            if (c != expected) {
-                // mismatch
-                ms_ungetc(ms);
+            if (!matchLiteral(ms, *format++)) {
                 // stop
                 break;
             }
@@ -548,4 +176,380 @@ int fast_fscanf_mem(
 
     va_end(args);
     return matchedCount;
-}
\ No newline at end of file
+}
+
+// -------------------------------------------------------------------------
+// Precompiled format plans.
+//
+// When the same format is used for every record, walking it character by
+// character on each call is pure overhead. ffs_compile() decodes the format
+// once into a compact opcode vector; ffs_scan_plan() then only executes it.
+//
+//   FfsPlan *plan = ffs_compile(":%lx[%hd]( %hd %hu ... %hd:%hd:%hd\n");
+//   while (ffs_scan_plan(plan, buffer, bufsize, &offset, &rec.pn_prog, ...) == 16) {
+//       // got one record
+//   }
+//   ffs_free_plan(plan);
+// -------------------------------------------------------------------------
+struct FfsPlan {
+    std::vector<FfsOp> ops;
+    int fieldCount;    // number of OP_CONVERT entries that fill an argument
+};
+
+/**
+ * Compiles a format string into a plan.
+ * Returns nullptr if the format is malformed or uses an unsupported
+ * conversion; the caller owns the plan and releases it with ffs_free_plan().
+ */
+extern "C"
+FfsPlan *ffs_compile(const char *format)
+{
+    if (!format) return nullptr;
+
+    FfsPlan *plan = new (std::nothrow) FfsPlan;
+    if (!plan) return nullptr;
+    plan->fieldCount = 0;
+
+    try {
+        FfsOp op;
+        int r;
+        while ((r = nextOp(format, op)) == 1) {
+            if (op.kind == OP_CONVERT) {
+                if (op.conv == CONV_UNSUPPORTED) {
+                    delete plan;
+                    return nullptr;
+                }
+                if (!op.suppress) plan->fieldCount++;
+            }
+            plan->ops.push_back(op);
+        }
+        if (r < 0) {
+            delete plan;
+            return nullptr;
+        }
+        plan->ops.shrink_to_fit();
+    } catch (...) {
+        delete plan;
+        return nullptr;
+    }
+    return plan;
+}
+
+/** Releases a plan returned by ffs_compile(). */
+extern "C"
+void ffs_free_plan(FfsPlan *plan)
+{
+    delete plan;
+}
+
+/**
+ * Same contract as fast_fscanf_mem, but runs a precompiled plan instead of
+ * interpreting a format string.
+ */
+extern "C"
+int ffs_scan_plan(
+    const FfsPlan *plan,
+    const char *buffer, size_t size,
+    size_t *offset, ...
+) {
+    if (!plan) return 0;
+
+    MemScanner ms;
+    ms.ptr = buffer + *offset;
+    ms.end = buffer + size;
+
+    va_list args;
+    va_start(args, offset);
+
+    int matchedCount = 0;
+
+    for (const FfsOp &op : plan->ops) {
+        if (op.kind == OP_CONVERT) {
+            if (op.suppress) {
+                if (!skipField(ms, op.conv)) break;
+                continue;
+            }
+            if (!scanConversion(ms, op, &args)) break;
+            matchedCount++;
+        } else if (op.kind == OP_SKIP_WS) {
+            ms_skip_whitespace(ms);
+        } else {
+            if (!matchLiteral(ms, op.literal)) break;
+        }
+    }
+
+    *offset = (size_t)(ms.ptr - buffer);
+
+    va_end(args);
+    return matchedCount;
+}
+
+// -------------------------------------------------------------------------
+// Predicate pushdown.
+//
+// ffs_scan_plan_filtered runs a plan like ffs_scan_plan, but checks each
+// predicate right after its field is converted. The first failing predicate
+// abandons the record: the rest of the line is not decoded, the scanner jumps
+// past the next '\n' with the SIMD newline search and FFS_REJECTED is
+// returned. Put selective predicates on early fields to skip the most work.
+// -------------------------------------------------------------------------
+
+/** Pointer that the next conversion of 'op' will store through. */
+static void *argPointer(const FfsOp &op, va_list *args)
+{
+    switch (op.conv)
+    {
+    case CONV_SHORT:      return va_arg(*args, short*);
+    case CONV_INT:        return va_arg(*args, int*);
+    case CONV_LONG:       return va_arg(*args, long*);
+    case CONV_USHORT:
+    case CONV_HEX_USHORT: return va_arg(*args, unsigned short*);
+    case CONV_UINT:
+    case CONV_HEX_UINT:   return va_arg(*args, unsigned int*);
+    case CONV_ULONG:
+    case CONV_HEX_ULONG:  return va_arg(*args, unsigned long*);
+    case CONV_FLOAT:      return va_arg(*args, float*);
+    case CONV_DOUBLE:     return va_arg(*args, double*);
+    case CONV_LDOUBLE:    return va_arg(*args, long double*);
+    case CONV_VIEW:       return va_arg(*args, FfsStringView*);
+    default:              return va_arg(*args, char*);
+    }
+}
+
+/** Converted value of a numeric field, as a double; chars and strings
+    never satisfy a predicate. */
+static bool fieldValue(const FfsOp &op, const void *p, double &v)
+{
+    switch (op.conv)
+    {
+    case CONV_SHORT:      v = *(const short *)p; return true;
+    case CONV_INT:        v = *(const int *)p; return true;
+    case CONV_LONG:       v = (double)*(const long *)p; return true;
+    case CONV_USHORT:
+    case CONV_HEX_USHORT: v = *(const unsigned short *)p; return true;
+    case CONV_UINT:
+    case CONV_HEX_UINT:   v = *(const unsigned int *)p; return true;
+    case CONV_ULONG:
+    case CONV_HEX_ULONG:  v = (double)*(const unsigned long *)p; return true;
+    case CONV_FLOAT:      v = *(const float *)p; return true;
+    case CONV_DOUBLE:     v = *(const double *)p; return true;
+    case CONV_LDOUBLE:    v = (double)*(const long double *)p; return true;
+    default:              return false;
+    }
+}
+
+/**
+ * ffs_scan_plan with predicates: preds[i] keeps the record only when field
+ * preds[i].field (0-based among the fields that take an argument) is within
+ * [lo, hi], compared as double. Returns the matched count as ffs_scan_plan
+ * does, or FFS_REJECTED with *offset just past the rejected line, or
+ * FFS_BAD_PREDICATE without scanning when a field is not one of the plan's.
+ */
+extern "C"
+int ffs_scan_plan_filtered(
+    const FfsPlan *plan,
+    const FfsPredicate *preds, int npreds,
+    const char *buffer, size_t size,
+    size_t *offset, ...
+) {
+    if (!plan) return 0;
+
+    if (npreds > 0 && !preds) return FFS_BAD_PREDICATE;
+
+    // fields that have a predicate, so most fields cost one bit test
+    uint64_t watched = 0;
+    for (int i = 0; i < npreds; ++i) {
+        int field = preds[i].field;
+        if (field < 0 || field >= plan->fieldCount || field >= 64)
+            return FFS_BAD_PREDICATE;
+        watched |= 1ULL << field;
+    }
+
+    MemScanner ms;
+    ms.ptr = buffer + *offset;
+    ms.end = buffer + size;
+
+    va_list args;
+    va_start(args, offset);
+
+    int matchedCount = 0;
+    bool rejected = false;
+
+    for (const FfsOp &op : plan->ops) {
+        if (op.kind == OP_CONVERT) {
+            if (op.suppress) {
+                if (!skipField(ms, op.conv)) break;
+                continue;
+            }
+            int field = matchedCount;
+            void *dest = nullptr;
+            if (field < 64 && (watched >> field) & 1) {
+                va_list peek;
+                va_copy(peek, args);
+                dest = argPointer(op, &peek);
+                va_end(peek);
+            }
+            if (!scanConversion(ms, op, &args)) break;
+            matchedCount++;
+            if (dest) {
+                double v = 0;
+                bool numeric = fieldValue(op, dest, v);
+                for (int i = 0; i < npreds && !rejected; ++i) {
+                    if (preds[i].field == field && (!numeric || v < preds[i].lo || v > preds[i].hi))
+                        rejected = true;
+                }
+                if (rejected) break;
+            }
+        } else if (op.kind == OP_SKIP_WS) {
+            ms_skip_whitespace(ms);
+        } else {
+            if (!matchLiteral(ms, op.literal)) break;
+        }
+    }
+
+    if (rejected) {
+        ms.ptr = ffs_find_char(ms.ptr, ms.end, '\n');
+        if (ms.ptr < ms.end) ms.ptr++;
+    }
+    *offset = (size_t)(ms.ptr - buffer);
+
+    va_end(args);
+    return rejected ? FFS_REJECTED : matchedCount;
+}
+
+// -------------------------------------------------------------------------
+// Line-start index
+//
+// One vectorised pass (ffs_index_lines) finds every line start, so callers
+// can jump to record i, count records or split work on line boundaries
+// without parsing:
+//
+//   size_t lines;
+//   size_t *idx = ffs_line_index(buffer, size, &lines);
+//   // line i is buffer[idx[i] .. idx[i + 1])
+//   ffs_free_line_index(idx);
+// -------------------------------------------------------------------------
+
+/**
+ * Builds the line-start index of buffer. Returns an array of *count + 1
+ * offsets, the last one being 'size', or nullptr when out of memory. The
+ * buffer is scanned twice: once to count, once to fill.
+ */
+extern "C"
+size_t *ffs_line_index(const char *buffer, size_t size, size_t *count)
+{
+    size_t n = ffs_index_lines(buffer, size, nullptr, 0);
+    size_t *starts = (size_t *)std::malloc((n + 1) * sizeof(size_t));
+    if (!starts) return nullptr;
+    ffs_index_lines(buffer, size, starts, n);
+    starts[n] = size;
+    if (count) *count = n;
+    return starts;
+}
+
+/** Releases an index returned by ffs_line_index(). */
+extern "C"
+void ffs_free_line_index(size_t *index)
+{
+    std::free(index);
+}
+
+// -------------------------------------------------------------------------
+// Parallel driver
+//
+// The buffer is cut into 'threads' byte ranges of about the same size, each
+// boundary moved forward to just after the next '\n', so every range holds
+// whole lines. Range i is handed to fn(begin, size, i, ctx) on its own thread
+// (range 0 on the calling one); fn must only write to state owned by chunk
+// i, which lets the caller merge per-chunk outputs in file order afterwards.
+// -------------------------------------------------------------------------
+
+/** Number of hardware threads, at least 1. */
+extern "C"
+int ffs_hardware_threads(void)
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? (int)n : 1;
+}
+
+namespace {
+
+/** Calls task(i) for i in 0 .. threads-1, task(0) on the calling thread and
+    the others on their own; a task whose thread cannot be started runs on
+    the calling thread. Returns when all are done. */
+template <class F>
+void runOnThreads(int threads, F task)
+{
+    std::vector<std::thread> pool;
+    try {
+        pool.reserve((size_t)threads);
+    } catch (...) {
+    }
+    for (int i = 1; i < threads; ++i) {
+        try {
+            pool.emplace_back(task, i);
+        } catch (...) {
+            task(i);
+        }
+    }
+    task(0);
+    for (std::thread &t : pool) t.join();
+}
+
+} // namespace
+
+/**
+ * Runs fn(i, ctx) for every i in 0 .. threads-1 in parallel, i = 0 on the
+ * calling thread, and returns when they have all finished.
+ */
+extern "C"
+void ffs_run_parallel(int threads, FfsTaskFn fn, void *ctx)
+{
+    if (!fn) return;
+    if (threads < 1) threads = 1;
+    runOnThreads(threads, [&](int i) { fn(i, ctx); });
+}
+
+/**
+ * Runs fn over 'threads' newline-aligned ranges of buffer in parallel and
+ * returns the sum of the counts it reports. Ranges may be empty when lines
+ * are long compared to size/threads; fn is still called for them. If a
+ * thread cannot be started its range runs on the calling thread.
+ */
+extern "C"
+unsigned long ffs_parse_parallel(
+    const char *buffer, size_t size,
+    int threads, FfsRangeFn fn, void *ctx
+) {
+    if (!fn) return 0;
+    if (threads < 1) threads = 1;
+
+    std::vector<size_t> bounds;
+    std::vector<unsigned long> counts;
+    try {
+        bounds.resize((size_t)threads + 1);
+        counts.assign((size_t)threads, 0);
+    } catch (...) {
+        return fn(buffer, size, 0, ctx);
+    }
+
+    bounds[0] = 0;
+    for (int i = 1; i < threads; ++i) {
+        size_t b = (size_t)((unsigned long long)size * (unsigned)i / (unsigned)threads);
+        if (b < bounds[i - 1]) b = bounds[i - 1];
+        if (b > 0 && b < size && buffer[b - 1] != '\n') {
+            const char *nl = (const char *)memchr(buffer + b, '\n', size - b);
+            b = nl ? (size_t)(nl - buffer) + 1 : size;
+        }
+        bounds[i] = b;
+    }
+    bounds[threads] = size;
+
+    runOnThreads(threads, [&](int i) {
+        counts[i] = fn(buffer + bounds[i], bounds[i + 1] - bounds[i], i, ctx);
+    });
+
+    unsigned long total = 0;
+    for (unsigned long c : counts) total += c;
+    return total;
+}
@@ -0,0 +1,690 @@
+/* fast_fscanf.h - memory-based scanf-like parsing (see fast_fscanf.cpp) */
+#ifndef FAST_FSCANF_H
+#define FAST_FSCANF_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* %S: a string field returned in place, 'len' bytes at 'ptr' inside the
+   scanned buffer (not NUL-terminated, valid as long as the buffer is) */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} FfsStringView;
+
+/* Every buffer passed to these functions (and to fscanfasta::scan) must be
+   followed by 64 readable bytes, FFS_PADDING in ffs_kernels.h: the kernels
+   load across the end of the input. The fscanfasta.c loaders zero them. */
+
+/* scanf-like parsing of buffer[*offset .. size), see fast_fscanf.cpp */
+int fast_fscanf_mem(
+    const char *buffer, size_t size,
+    size_t *offset,
+    const char *format, ...
+);
+
+/* Precompiled format plan (see ffs_compile in fast_fscanf.cpp) */
+typedef struct FfsPlan FfsPlan;
+FfsPlan *ffs_compile(const char *format);
+int ffs_scan_plan(
+    const FfsPlan *plan,
+    const char *buffer, size_t size,
+    size_t *offset, ...
+);
+void ffs_free_plan(FfsPlan *plan);
+
+/* Predicate pushdown (see ffs_scan_plan_filtered in fast_fscanf.cpp):
+   keep a record only when converted field 'field' is in [lo, hi] */
+typedef struct {
+    int field;
+    double lo, hi;
+} FfsPredicate;
+#define FFS_REJECTED (-1)
+#define FFS_BAD_PREDICATE (-2)   /* field out of the plan's range */
+int ffs_scan_plan_filtered(
+    const FfsPlan *plan,
+    const FfsPredicate *preds, int npreds,
+    const char *buffer, size_t size,
+    size_t *offset, ...
+);
+
+/* Line-start index (see ffs_line_index in fast_fscanf.cpp) */
+size_t *ffs_line_index(const char *buffer, size_t size, size_t *count);
+void ffs_free_line_index(size_t *index);
+
+/* Parallel driver (see ffs_parse_parallel in fast_fscanf.cpp): fn parses one
+   newline-aligned range and returns its record count */
+typedef unsigned long (*FfsRangeFn)(const char *buffer, size_t size, int chunk, void *ctx);
+unsigned long ffs_parse_parallel(
+    const char *buffer, size_t size,
+    int threads, FfsRangeFn fn, void *ctx
+);
+int ffs_hardware_threads(void);
+
+/* Runs fn(0, ctx) .. fn(threads - 1, ctx) in parallel and waits for them
+   (see ffs_run_parallel in fast_fscanf.cpp) */
+typedef void (*FfsTaskFn)(int task, void *ctx);
+void ffs_run_parallel(int threads, FfsTaskFn fn, void *ctx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ffs_kernels.h"
+
+namespace fscanfasta {
+namespace detail {
+
+// -------------------------------------------------------------------------
+// Scanner primitives, shared by fast_fscanf_mem, the plans and fscanfasta::scan.
+// They live in the header so that fscanfasta::scan can inline them at the call site.
+// -------------------------------------------------------------------------
+
+// We'll use a lightweight "scanner" struct to walk the buffer by pointer:
+struct MemScanner {
+    const char *ptr;   // current position
+    const char *end;   // one-past the last valid character
+};
+
+/** Returns true if we're out of data. */
+inline bool ms_eof(const MemScanner &ms)
+{
+    return (ms.ptr >= ms.end);
+}
+
+/** Peek a character (0 if EOF). */
+inline char ms_peek(const MemScanner &ms)
+{
+    return ms_eof(ms) ? '\0' : *ms.ptr;
+}
+
+/** Advance one char; return it, or 0 if EOF. */
+inline char ms_getc(MemScanner &ms)
+{
+    if (ms_eof(ms)) return '\0';
+    return *ms.ptr++;
+}
+
+/** "Ungetc" by moving back 1 char (if not at start). */
+inline void ms_ungetc(MemScanner &ms)
+{
+    // We'll just move ptr back by 1 if possible
+    if (ms.ptr > ms.end) {
+        // If we were out of range, clamp
+        ms.ptr = ms.end;
+    }
+    if (ms.ptr > (ms.end - (ms.end - ms.ptr)) ) {
+        // basically do: if (we're not at the beginning) go back
+        ms.ptr--;
+    }
+}
+
+/** Skip whitespace. */
+inline void ms_skip_whitespace(MemScanner &ms)
+{
+    ms.ptr = ffs_skip_space(ms.ptr, ms.end);
+}
+
+// -------------------------------------------------------------------------
+// readChar: for '%c' – read exactly 1 char, even if it's whitespace.
+// -------------------------------------------------------------------------
+inline bool readChar(MemScanner &ms, char &out)
+{
+    if (ms_eof(ms)) {
+        return false;
+    }
+    out = ms_getc(ms);
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// readString: for '%s' – skip leading whitespace, then read until next space
+// or punctuation. Actually, real scanf stops at whitespace for "%s". We'll do
+// the same. If you want punctuation-based stop for strings, you'd do something else.
+//
+// width > 0 => maximum length (minus 1 for null terminator).
+// Returns true if we got at least 1 char.
+// -------------------------------------------------------------------------
+inline bool readString(MemScanner &ms, char *dest, int width)
+{
+    if (!dest) return false;
+    if (width <= 0) {
+        // treat 0 or negative as "some big limit"
+        width = 1024 * 1024;
+    }
+
+    ms_skip_whitespace(ms);
+
+    // like the byte loop it replaces, the whole token is consumed and what
+    // does not fit is dropped
+    const char *tok = ms.ptr;
+    ms.ptr = ffs_find_space(tok, ms.end);
+    size_t count = (size_t)(ms.ptr - tok);
+    if (count == 0) {
+        return false;
+    }
+    if (count > (size_t)(width - 1)) {
+        count = (size_t)(width - 1);
+    }
+    ffs_copy_bytes(dest, tok, count);
+    dest[count] = '\0';
+    return true;
+}
+
+/** %S: the token %s would read, returned as a view into the input instead
+    of a copy. The whole token is consumed; a width caps the view length. */
+inline bool readView(MemScanner &ms, const char *&ptr, size_t &len, int width)
+{
+    ms_skip_whitespace(ms);
+    const char *tok = ms.ptr;
+    ms.ptr = ffs_find_space(tok, ms.end);
+    size_t n = (size_t)(ms.ptr - tok);
+    if (n == 0) {
+        return false;
+    }
+    ptr = tok;
+    len = (width > 0 && n > (size_t)width) ? (size_t)width : n;
+    return true;
+}
+
+inline bool readView(MemScanner &ms, FfsStringView &out, int width)
+{
+    return readView(ms, out.ptr, out.len, width);
+}
+
+inline bool readView(MemScanner &ms, std::string_view &out, int width)
+{
+    const char *ptr;
+    size_t len;
+    if (!readView(ms, ptr, len, width)) {
+        return false;
+    }
+    out = std::string_view(ptr, len);
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// Typed conversions: one per family of specifiers. Both the va_list
+// interpreter and the template front-end end up in these.
+//
+// They convert straight from [ms.ptr, ms.end) with the ffs_kernels.h
+// parsers (ffs_parse_u64, ffs_parse_hex_u64, ffs_parse_float/_double/
+// _long_double) and advance the scanner by the consumed length: no token
+// is copied out.
+// -------------------------------------------------------------------------
+
+/** %hd, %d, %ld: parse as long (SWAR digit kernel), then narrow to T. */
+template <class T>
+inline bool scanSigned(MemScanner &ms, T &out)
+{
+    ms_skip_whitespace(ms);
+    const char *p = ms.ptr;
+    bool neg = false;
+    if (p < ms.end && (*p == '+' || *p == '-')) {
+        neg = (*p == '-');
+        p++;
+    }
+
+    uint64_t mag = 0;
+    const char *q = ffs_parse_u64(p, ms.end, &mag);
+    if (!q || q == p) {
+        return false;
+    }
+    // same range as parsing into a long
+    if (mag > (neg ? (uint64_t)LONG_MAX + 1 : (uint64_t)LONG_MAX)) {
+        return false;
+    }
+    out = (T)(neg ? (long)(0 - mag) : (long)mag);
+    ms.ptr = q;
+    return true;
+}
+
+/** %hu, %u, %lu (Base 10, SWAR digit kernel) and %hx, %x, %lx (Base 16,
+    SSE2 hex kernel). */
+template <int Base, class T>
+inline bool scanUnsigned(MemScanner &ms, T &out)
+{
+    static_assert(Base == 10 || Base == 16, "decimal or hex only");
+    ms_skip_whitespace(ms);
+    const char *p = ms.ptr;
+
+    uint64_t val = 0;
+    const char *q = (Base == 10) ? ffs_parse_u64(p, ms.end, &val)
+                                 : ffs_parse_hex_u64(p, ms.end, &val);
+    if (!q || q == p || val > ULONG_MAX) {
+        return false;
+    }
+    out = (T)val;
+    ms.ptr = q;
+    return true;
+}
+
+/** %f, %lf: Eisel-Lemire decoder straight to float/double (one rounding).
+    %Lf: exact long double fast path, strtold only when that can't apply. */
+template <class T>
+inline bool scanFloat(MemScanner &ms, T &out)
+{
+    ms_skip_whitespace(ms);
+
+    const char *q;
+    if constexpr (std::is_same_v<T, float>) {
+        q = ffs_parse_float(ms.ptr, ms.end, &out);
+    } else if constexpr (std::is_same_v<T, double>) {
+        q = ffs_parse_double(ms.ptr, ms.end, &out);
+    } else {
+        q = ffs_parse_long_double(ms.ptr, ms.end, &out);
+    }
+    if (!q) {
+        return false;
+    }
+    ms.ptr = q;
+    return true;
+}
+
+/** Skip input whitespace, then match one literal character. */
+inline bool matchLiteral(MemScanner &ms, char expected)
+{
+    // skip whitespace in the input before matching a literal
+    ms_skip_whitespace(ms);
+
+    // read one char from input
+    if (ms_eof(ms)) {
+        // can't match
+        return false;
+    }
+    char c = ms_getc(ms);
+    if (c != expected) {
+        // mismatch
+        ms_ungetc(ms);
+        return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// Conversion decoding: a "%..." specifier is turned into one FfsOp, so that the
+// interpreter (fast_fscanf_mem), the precompiled plans (ffs_compile) and the
+// compile-time front-end (fscanfasta::scan) share exactly the same rules.
+// -------------------------------------------------------------------------
+enum FfsConv : unsigned char {
+    CONV_SHORT, CONV_INT, CONV_LONG,                // %hd %d %ld
+    CONV_USHORT, CONV_UINT, CONV_ULONG,             // %hu %u %lu
+    CONV_HEX_USHORT, CONV_HEX_UINT, CONV_HEX_ULONG, // %hx %x %lx
+    CONV_FLOAT, CONV_DOUBLE, CONV_LDOUBLE,          // %f %lf %Lf (also g/e)
+    CONV_CHAR, CONV_STRING, CONV_VIEW,              // %c %s %S
+    CONV_UNSUPPORTED
+};
+
+enum FfsOpKind : unsigned char {
+    OP_CONVERT,   // one conversion, fills one argument
+    OP_SKIP_WS,   // whitespace in the format: skip any whitespace in the input
+    OP_LITERAL    // literal character: skip whitespace, then match it exactly
+};
+
+struct FfsOp {
+    unsigned char kind;     // FfsOpKind
+    unsigned char conv;     // FfsConv (OP_CONVERT only)
+    char          literal;  // expected character (OP_LITERAL only)
+    unsigned char suppress; // "%*d": skip the field, no argument, not counted
+    int           width;    // maximum field width, 0 = none (only %s uses it)
+};
+
+constexpr bool isFormatDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool isFormatSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * Decodes the specifier that follows a '%'. On entry 'format' points just past
+ * the '%', on exit just past the conversion character.
+ * Returns false if the format ends before the conversion character.
+ */
+constexpr bool decodeConversion(const char *&format, FfsOp &op)
+{
+    op.kind     = OP_CONVERT;
+    op.literal  = 0;
+    op.suppress = 0;
+    op.width    = 0;
+
+    // assignment suppression
+    if (*format == '*') {
+        op.suppress = 1;
+        format++;
+    }
+
+    // field width (like "%63s"); a precision (".2") is accepted and ignored
+    while (isFormatDigit(*format)) {
+        op.width = op.width * 10 + (*format++ - '0');
+    }
+    if (*format == '.') {
+        format++;
+        while (isFormatDigit(*format)) format++;
+    }
+
+    // length modifiers
+    bool isShort      = false;  // 'h'
+    bool isLong       = false;  // 'l'
+    bool isLongDouble = false;  // 'L'
+
+    if (*format == 'h') {
+        isShort = true;
+        format++;
+    } else if (*format == 'l') {
+        isLong = true;
+        format++;
+    } else if (*format == 'L') {
+        isLongDouble = true;
+        format++;
+    }
+
+    char spec = *format;
+    if (spec == '\0') {
+        // format ended abruptly
+        return false;
+    }
+    format++;
+
+    switch (spec) {
+    case 'd': op.conv = isShort ? CONV_SHORT  : isLong ? CONV_LONG  : CONV_INT;  break;
+    case 'u': op.conv = isShort ? CONV_USHORT : isLong ? CONV_ULONG : CONV_UINT; break;
+    case 'x': op.conv = isShort ? CONV_HEX_USHORT : isLong ? CONV_HEX_ULONG : CONV_HEX_UINT; break;
+    case 'f':
+    case 'g':
+    case 'e': op.conv = isLongDouble ? CONV_LDOUBLE : isLong ? CONV_DOUBLE : CONV_FLOAT; break;
+    case 'c': op.conv = CONV_CHAR;   break;
+    case 's': op.conv = CONV_STRING; break;
+    case 'S': op.conv = CONV_VIEW;   break;
+    default:  op.conv = CONV_UNSUPPORTED; break;
+    }
+    return true;
+}
+
+/**
+ * Decodes the next opcode of a format string and advances 'format' past it.
+ * A run of format whitespace becomes a single OP_SKIP_WS.
+ * Returns 1 if an opcode was produced, 0 at the end of the format and -1 if
+ * the format ends inside a conversion.
+ */
+constexpr int nextOp(const char *&format, FfsOp &op)
+{
+    if (*format == '\0') {
+        return 0;
+    }
+    if (*format == '%') {
+        format++;
+        return decodeConversion(format, op) ? 1 : -1;
+    }
+    op.conv     = CONV_UNSUPPORTED;
+    op.literal  = 0;
+    op.suppress = 0;
+    op.width    = 0;
+    if (isFormatSpace(*format)) {
+        while (isFormatSpace(*format)) format++;
+        op.kind = OP_SKIP_WS;
+    } else {
+        op.kind    = OP_LITERAL;
+        op.literal = *format++;
+    }
+    return 1;
+}
+
+/** %*...: pass over the field a conversion would consume, without
+    converting it. Fails where the conversion would fail for lack of a
+    number or token, but does not range-check. */
+inline bool skipField(MemScanner &ms, unsigned char conv)
+{
+    if (conv == CONV_CHAR) {
+        if (ms_eof(ms)) return false;
+        ms.ptr++;
+        return true;
+    }
+    ms_skip_whitespace(ms);
+    const char *p = ms.ptr;
+    const char *q;
+    switch (conv) {
+    case CONV_SHORT:
+    case CONV_INT:
+    case CONV_LONG:
+        if (p < ms.end && (*p == '+' || *p == '-')) p++;
+        q = ffs_skip_digits(p, ms.end);
+        break;
+    case CONV_USHORT:
+    case CONV_UINT:
+    case CONV_ULONG:
+        q = ffs_skip_digits(p, ms.end);
+        break;
+    case CONV_HEX_USHORT:
+    case CONV_HEX_UINT:
+    case CONV_HEX_ULONG:
+        q = ffs_skip_hex(p, ms.end);
+        break;
+    case CONV_FLOAT:
+    case CONV_DOUBLE:
+    case CONV_LDOUBLE:
+        q = ffs_skip_float(p, ms.end);
+        if (!q) return false;
+        ms.ptr = q;
+        return true;
+    case CONV_STRING:
+    case CONV_VIEW:
+        // readString and readView consume the whole token whatever the width
+        q = ffs_find_space(p, ms.end);
+        break;
+    default:
+        return false;
+    }
+    if (q == p) return false;
+    ms.ptr = q;
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// Compile-time format handling for fscanfasta::scan.
+// -------------------------------------------------------------------------
+
+struct TmplOp {
+    FfsOp op;
+    int   arg;     // argument index for OP_CONVERT, -1 otherwise
+};
+
+template <std::size_t N>
+struct TmplFormat {
+    std::array<TmplOp, N> ops {};
+    std::size_t count = 0;
+    int  fields = 0;
+    bool valid  = true;
+};
+
+template <std::size_t N>
+constexpr TmplFormat<N> compileFormat(const char (&str)[N])
+{
+    TmplFormat<N> out;
+    const char *format = str;
+    FfsOp op {};
+    int r;
+    while ((r = nextOp(format, op)) == 1) {
+        TmplOp t { op, -1 };
+        if (op.kind == OP_CONVERT) {
+            if (op.conv == CONV_UNSUPPORTED) {
+                out.valid = false;
+                break;
+            }
+            if (!op.suppress) t.arg = out.fields++;
+        }
+        out.ops[out.count++] = t;
+    }
+    if (r < 0) {
+        out.valid = false;
+    }
+    return out;
+}
+
+/** Does an argument of type T match conversion Conv? */
+template <unsigned char Conv, class T>
+constexpr bool argMatches()
+{
+    if constexpr (Conv == CONV_SHORT)       return std::is_same_v<T, short>;
+    else if constexpr (Conv == CONV_INT)    return std::is_same_v<T, int>;
+    else if constexpr (Conv == CONV_LONG)   return std::is_same_v<T, long>;
+    else if constexpr (Conv == CONV_USHORT || Conv == CONV_HEX_USHORT)
+        return std::is_same_v<T, unsigned short>;
+    else if constexpr (Conv == CONV_UINT || Conv == CONV_HEX_UINT)
+        return std::is_same_v<T, unsigned int>;
+    else if constexpr (Conv == CONV_ULONG || Conv == CONV_HEX_ULONG)
+        return std::is_same_v<T, unsigned long>;
+    else if constexpr (Conv == CONV_FLOAT)   return std::is_same_v<T, float>;
+    else if constexpr (Conv == CONV_DOUBLE)  return std::is_same_v<T, double>;
+    else if constexpr (Conv == CONV_LDOUBLE) return std::is_same_v<T, long double>;
+    else if constexpr (Conv == CONV_CHAR)    return std::is_same_v<T, char>;
+    else if constexpr (Conv == CONV_STRING)
+        return std::is_same_v<T, char *> ||
+               (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>);
+    else if constexpr (Conv == CONV_VIEW)
+        return std::is_same_v<T, FfsStringView> || std::is_same_v<T, std::string_view>;
+    else return false;
+}
+
+} // namespace detail
+
+/** A format string usable as a template argument: fscanfasta::scan<"%d %d">(...). */
+template <std::size_t N>
+struct fixed_format {
+    char str[N] {};
+    constexpr fixed_format(const char (&s)[N])
+    {
+        for (std::size_t i = 0; i < N; ++i) str[i] = s[i];
+    }
+};
+
+namespace detail {
+
+template <fixed_format F>
+struct CompiledFormat {
+    static constexpr auto value = compileFormat(F.str);
+};
+
+/** Executes opcode I of format F; the branch is resolved at compile time. */
+template <fixed_format F, std::size_t I, class Tuple>
+inline bool runOp(MemScanner &ms, Tuple &args, int &matched)
+{
+    constexpr TmplOp t = CompiledFormat<F>::value.ops[I];
+
+    if constexpr (t.op.kind == OP_SKIP_WS) {
+        ms_skip_whitespace(ms);
+        return true;
+    } else if constexpr (t.op.kind == OP_LITERAL) {
+        return matchLiteral(ms, t.op.literal);
+    } else if constexpr (t.op.suppress) {
+        return skipField(ms, t.op.conv);
+    } else {
+        auto &arg = std::get<t.arg>(args);
+        using A = std::remove_reference_t<decltype(arg)>;
+        static_assert(argMatches<t.op.conv, A>(),
+                      "fscanfasta::scan: argument type does not match its conversion");
+
+        bool ok;
+        if constexpr (t.op.conv == CONV_SHORT || t.op.conv == CONV_INT ||
+                      t.op.conv == CONV_LONG) {
+            ok = scanSigned(ms, arg);
+        } else if constexpr (t.op.conv == CONV_USHORT || t.op.conv == CONV_UINT ||
+                             t.op.conv == CONV_ULONG) {
+            ok = scanUnsigned<10>(ms, arg);
+        } else if constexpr (t.op.conv == CONV_HEX_USHORT || t.op.conv == CONV_HEX_UINT ||
+                             t.op.conv == CONV_HEX_ULONG) {
+            ok = scanUnsigned<16>(ms, arg);
+        } else if constexpr (t.op.conv == CONV_FLOAT || t.op.conv == CONV_DOUBLE ||
+                             t.op.conv == CONV_LDOUBLE) {
+            ok = scanFloat(ms, arg);
+        } else if constexpr (t.op.conv == CONV_CHAR) {
+            ok = readChar(ms, arg);
+        } else if constexpr (t.op.conv == CONV_VIEW) {
+            ok = readView(ms, arg, t.op.width);
+        } else if constexpr (std::is_array_v<A>) {
+            // bounded by the destination array as well as by the field width
+            constexpr int cap = (int)std::extent_v<A>;
+            constexpr int lim = (t.op.width > 0 && t.op.width + 1 < cap) ? t.op.width + 1 : cap;
+            ok = readString(ms, arg, lim);
+        } else {
+            ok = readString(ms, arg, (t.op.width > 0 ? t.op.width + 1 : 1024));
+        }
+        if (!ok) {
+            return false;
+        }
+        matched++;
+        return true;
+    }
+}
+
+template <fixed_format F, class Tuple, std::size_t... I>
+inline void runOps(MemScanner &ms, Tuple &args, int &matched, std::index_sequence<I...>)
+{
+    // && short-circuits, so the first mismatch stops the scan like in the
+    // interpreter
+    (void)(runOp<F, I>(ms, args, matched) && ...);
+}
+
+} // namespace detail
+
+/**
+ * Compile-time specialised scanner. The format is parsed during compilation
+ * and every opcode becomes straight-line code: there is no specifier dispatch
+ * and no va_arg, and the argument types are checked against the specifiers.
+ *
+ *   size_t offset = 0;
+ *   while (fscanfasta::scan<":%lx[%hd]( %hd ... %hd:%hd:%hd\n">(
+ *              std::span<const char>(buffer, size), offset,
+ *              rec.pn_prog, rec.pn_n, ...) == 16)
+ *   {
+ *       // got one record
+ *   }
+ *
+ * Same semantics and return value as fast_fscanf_mem.
+ */
+template <fixed_format F, class... Args>
+inline int scan(std::span<const char> input, std::size_t &offset, Args &... args)
+{
+    using Compiled = detail::CompiledFormat<F>;
+    static_assert(Compiled::value.valid,
+                  "fscanfasta::scan: malformed format or unsupported conversion");
+    static_assert(sizeof...(Args) == (std::size_t)Compiled::value.fields,
+                  "fscanfasta::scan: argument count does not match the format");
+
+    int matched = 0;
+    if constexpr (Compiled::value.valid &&
+                  sizeof...(Args) == (std::size_t)Compiled::value.fields) {
+        detail::MemScanner ms;
+        ms.ptr = input.data() + offset;
+        ms.end = input.data() + input.size();
+
+        auto refs = std::forward_as_tuple(args...);
+        detail::runOps<F>(ms, refs, matched,
+                          std::make_index_sequence<Compiled::value.count>{});
+
+        offset = (std::size_t)(ms.ptr - input.data());
+    }
+    return matched;
+}
+
+} // namespace fscanfasta
+
+#endif /* __cplusplus */
+
+#endif /* FAST_FSCANF_H */
@@ -0,0 +1,962 @@
+/* ffs_kernels.h - low-level parsing kernels shared by the C and C++ parsers
+ *
+ * Everything here is plain C (static inline) so that fscanfasta.c can use the
+ * kernels as well as fast_fscanf.h.
+ *
+ * Inputs are padded: at least FFS_PADDING readable bytes follow 'end' (the
+ * loaders zero them; inside a larger buffer they are simply the data that
+ * comes next). The word and vector kernels load across 'end' instead of
+ * finishing byte by byte, and clamp what they found to 'end'.
+ */
+#ifndef FFS_KERNELS_H
+#define FFS_KERNELS_H
+
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ffs_pow5_table.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Readable bytes required after the end of every input */
+#define FFS_PADDING 64
+
+/* SSE2 is part of every x86-64 target; other targets use the scalar code */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FFS_SSE2 1
+#else
+#define FFS_SSE2 0
+#endif
+
+/* AVX2 only when the build targets it (-mavx2, -march=native, /arch:AVX2) */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FFS_AVX2 1
+#else
+#define FFS_AVX2 0
+#endif
+
+/* The SWAR kernels want the first character in the lowest byte of a word */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define FFS_SWAR 0
+#else
+#define FFS_SWAR 1
+#endif
+
+/* ============== Bit helpers ============== */
+
+/* Count trailing zero bits, x != 0 */
+static inline int ffs_ctz64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return (int)idx;
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    if (_BitScanForward(&idx, (unsigned long)x)) return (int)idx;
+    _BitScanForward(&idx, (unsigned long)(x >> 32));
+    return (int)idx + 32;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+/* Reverse the byte order of a 64-bit word */
+static inline uint64_t ffs_bswap64(uint64_t x)
+{
+#if defined(_MSC_VER)
+    return _byteswap_uint64(x);
+#else
+    return __builtin_bswap64(x);
+#endif
+}
+
+/* Unaligned 8-byte load */
+static inline uint64_t ffs_load64(const char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* ============== Character classes ==============
+ *
+ * One 256-entry table in the "C" locale replaces isspace/isdigit/isxdigit:
+ * those go through the locale's table and are out-of-line calls from C++.
+ */
+
+#ifdef __cplusplus
+#define FFS_TABLE constexpr
+#else
+#define FFS_TABLE const
+#endif
+
+#define FFS_CT_SPACE  0x01    /* ' ' \t \n \v \f \r */
+#define FFS_CT_DIGIT  0x02    /* 0-9 */
+#define FFS_CT_XDIGIT 0x04    /* 0-9 a-f A-F */
+#define FFS_CT_PUNCT  0x08    /* literal punctuation of the record format: ( ) / : [ ] */
+
+/* 1 = space, 6 = digit (FFS_CT_DIGIT | FFS_CT_XDIGIT), 4 = a-f A-F, 8 = punctuation */
+static FFS_TABLE unsigned char ffs_ctype[256] = {
+    0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    1,0,0,0,0,0,0,0,8,8,0,0,0,0,0,8,
+    6,6,6,6,6,6,6,6,6,6,8,0,0,0,0,0,
+    0,4,4,4,4,4,4,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,8,0,8,0,0,
+    0,4,4,4,4,4,4,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+};
+
+static inline int ffs_is_space(char c)  { return ffs_ctype[(unsigned char)c] & FFS_CT_SPACE; }
+static inline int ffs_is_digit(char c)  { return ffs_ctype[(unsigned char)c] & FFS_CT_DIGIT; }
+static inline int ffs_is_xdigit(char c) { return ffs_ctype[(unsigned char)c] & FFS_CT_XDIGIT; }
+static inline int ffs_is_punct(char c)  { return ffs_ctype[(unsigned char)c] & FFS_CT_PUNCT; }
+
+/* Whitespace runs and tokens, 32 (AVX2) or 16 (SSE2) bytes at a time.
+   The control characters \t..\r are found with one unsigned range check:
+   c - 9 <= 4 */
+#if FFS_AVX2
+#define FFS_SPACE_BLOCK 32
+#elif FFS_SSE2
+#define FFS_SPACE_BLOCK 16
+#endif
+
+#ifdef FFS_SPACE_BLOCK
+/* Bit i is set when p[i] is whitespace, for the FFS_SPACE_BLOCK bytes at p */
+static inline uint32_t ffs_space_mask(const char *p)
+{
+#if FFS_AVX2
+    __m256i v   = _mm256_loadu_si256((const __m256i *)p);
+    __m256i t   = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t);
+    __m256i sp  = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(ctl, sp));
+#else
+    __m128i v   = _mm_loadu_si128((const __m128i *)p);
+    __m128i t   = _mm_sub_epi8(v, _mm_set1_epi8(9));
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);
+    __m128i sp  = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(ctl, sp));
+#endif
+}
+#endif
+
+/* First non-whitespace character at or after p, or end */
+static inline const char *ffs_skip_space(const char *p, const char *end)
+{
+    /* fields are mostly separated by nothing or a single blank */
+    if (p >= end || !ffs_is_space(*p)) return p;
+    if (++p >= end || !ffs_is_space(*p)) return p;
+#ifdef FFS_SPACE_BLOCK
+    /* over-reads: the last block runs into the padding */
+    for (; p < end; p += FFS_SPACE_BLOCK) {
+        uint32_t m = ~ffs_space_mask(p);
+#if FFS_SPACE_BLOCK == 16
+        m &= 0xFFFF;
+#endif
+        if (m) {
+            p += ffs_ctz64(m);
+            return (p < end) ? p : end;
+        }
+    }
+    return end;
+#else
+    while (p < end && ffs_is_space(*p)) p++;
+    return p;
+#endif
+}
+
+/* First whitespace character at or after p (the end of a %s token), or end */
+static inline const char *ffs_find_space(const char *p, const char *end)
+{
+#ifdef FFS_SPACE_BLOCK
+    /* over-reads: the last block runs into the padding */
+    for (; p < end; p += FFS_SPACE_BLOCK) {
+        uint32_t m = ffs_space_mask(p);
+        if (m) {
+            p += ffs_ctz64(m);
+            return (p < end) ? p : end;
+        }
+    }
+    return end;
+#else
+    while (p < end && !ffs_is_space(*p)) p++;
+    return p;
+#endif
+}
+
+/* memcpy(dst, src, n) for tokens: fixed-size (overlapping) moves that the
+   compiler inlines, so a short %s copy does not pay for a library call */
+static inline void ffs_copy_bytes(char *dst, const char *src, size_t n)
+{
+    if (n >= 16) {
+        size_t i = 0;
+        for (; i + 16 < n; i += 16) memcpy(dst + i, src + i, 16);
+        memcpy(dst + n - 16, src + n - 16, 16);
+    } else if (n >= 8) {
+        memcpy(dst, src, 8);
+        memcpy(dst + n - 8, src + n - 8, 8);
+    } else if (n >= 4) {
+        memcpy(dst, src, 4);
+        memcpy(dst + n - 4, src + n - 4, 4);
+    } else if (n > 0) {
+        dst[0] = src[0];
+        dst[n / 2] = src[n / 2];
+        dst[n - 1] = src[n - 1];
+    }
+}
+
+/* ============== Decimal integers ============== */
+
+/* Number of leading decimal digits in a loaded 8-byte word (0..8).
+   A byte is a digit when its high nibble is 3 and its low nibble <= 9;
+   both tests are done on all bytes at once without carries between bytes. */
+static inline int ffs_digit_run8(uint64_t word)
+{
+    uint64_t hi  = (word & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL;
+    uint64_t lo  = ((word & 0x0F0F0F0F0F0F0F0FULL) + 0x0606060606060606ULL)
+                   & 0x1010101010101010ULL;
+    uint64_t bad = hi | lo;
+    /* one flag bit per non-digit byte */
+    uint64_t flags = (((bad & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | bad)
+                     & 0x8080808080808080ULL;
+    return flags ? (ffs_ctz64(flags) >> 3) : 8;
+}
+
+/* Value of the first n (1..8) digits of a loaded word. The digits are moved
+   to the top of the word (so the bytes shifted in act as leading zeros) and
+   combined pairwise with three multiply-shift steps. */
+static inline uint64_t ffs_digits8_value(uint64_t word, int n)
+{
+    uint64_t v = (word - 0x3030303030303030ULL) << (8 * (8 - n));
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return v;
+}
+
+/* Powers of ten that fit in 64 bits */
+static const uint64_t ffs_pow10_u64[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/* Parses a run of decimal digits (no sign) starting at p.
+   Returns a pointer past the last digit, p itself if there is no digit, or
+   NULL if the value does not fit in 64 bits. */
+static inline const char *ffs_parse_u64(const char *p, const char *end, uint64_t *out)
+{
+    const char *start = p;
+    uint64_t val = 0;
+
+#if FFS_SWAR
+    /* whole 8-digit blocks at once; at most two fit in 64 bits, anything
+       longer goes through the overflow-checked loop below. Over-reads: a
+       word near 'end' takes bytes of the padding, the run is clamped */
+    while (p < end && p - start < 16) {
+        uint64_t word = ffs_load64(p);
+        int n = ffs_digit_run8(word);
+        if (end - p < n) n = (int)(end - p);
+        if (n < 8) {
+            /* a short run: up to 7 more digits, converted in one go when
+               there are at least two (a single digit is cheaper scalar) */
+            if (n > 1) {
+                val = val * ffs_pow10_u64[n] + ffs_digits8_value(word, n);
+                p += n;
+                *out = val;
+                return p;
+            }
+            break;
+        }
+        val = val * 100000000ULL + ffs_digits8_value(word, 8);
+        p += 8;
+    }
+#endif
+
+    /* short tail (or 17+ digits): one digit at a time, overflow-checked */
+    while (p < end && (unsigned char)(*p - '0') <= 9) {
+        uint64_t d = (uint64_t)(*p - '0');
+        if (val > (UINT64_MAX - d) / 10) {
+            return NULL;
+        }
+        val = val * 10 + d;
+        p++;
+    }
+    *out = val;
+    return p;
+}
+
+/* Skips a run of decimal digits without converting it (projection: the
+   field is not wanted). Returns a pointer past the run, p if there is none. */
+static inline const char *ffs_skip_digits(const char *p, const char *end)
+{
+#if FFS_SWAR
+    /* over-reads, like ffs_parse_u64 */
+    while (p < end) {
+        int n = ffs_digit_run8(ffs_load64(p));
+        p += n;
+        if (n < 8) return (p < end) ? p : end;
+    }
+    return end;
+#else
+    while (p < end && (unsigned char)(*p - '0') <= 9) p++;
+    return p;
+#endif
+}
+
+/* ============== Hexadecimal integers ============== */
+
+/* Hex digit values, -1 for anything else (a table beats the two range
+   checks when letters and digits are mixed) */
+static const signed char ffs_hex_table[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+     0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+};
+
+/* Value of a hex digit, or -1 */
+static inline int ffs_hex_value(char c)
+{
+    return ffs_hex_table[(unsigned char)c];
+}
+
+/* Scalar hex loop: continues the value 'val' with the digits at p.
+   Same contract as ffs_parse_hex_u64. */
+static inline const char *ffs_parse_hex_scalar(const char *p, const char *end,
+                                               uint64_t val, uint64_t *out)
+{
+    int d;
+    while (p < end && (d = ffs_hex_value(*p)) >= 0) {
+        if (val >> 60) {
+            return NULL;
+        }
+        val = (val << 4) | (uint64_t)d;
+        p++;
+    }
+    *out = val;
+    return p;
+}
+
+/* Parses a run of hex digits (no sign, no "0x") starting at p.
+   Returns a pointer past the last digit, p itself if there is no digit, or
+   NULL if the value does not fit in 64 bits.
+
+   With SSE2 the whole run (a 64-bit value has at most 16 significant digits)
+   is classified and converted at once: the run length comes from a movemask
+   (clamped to 'end', the load may take bytes of the padding), nibbles are
+   packed in pairs with shifts and one packus, and the 16-digit big-endian
+   result is shifted down to the run length. */
+static inline const char *ffs_parse_hex_u64(const char *p, const char *end, uint64_t *out)
+{
+#if FFS_SSE2
+    if (p < end) {
+        __m128i v     = _mm_loadu_si128((const __m128i *)p);
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i isDig = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i isAlp = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(isDig, isAlp));
+        if (end - p < 16) mask &= (1u << (end - p)) - 1;
+        int n = (int)ffs_ctz64(~(uint64_t)mask);    /* 0..16 */
+        if (n == 0) {
+            *out = 0;
+            return p;
+        }
+
+        /* nibble per byte, zero from the first non-hex byte on */
+        __m128i nib  = _mm_or_si128(
+            _mm_and_si128(isDig, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+            _mm_and_si128(isAlp, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+        __m128i keep = _mm_cmplt_epi8(
+            _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm_set1_epi8((char)n));
+        nib = _mm_and_si128(nib, keep);
+
+        /* byte pairs -> one byte each: (first << 4) | second */
+        __m128i pairs = _mm_or_si128(_mm_slli_epi16(nib, 4), _mm_srli_epi16(nib, 8));
+        pairs = _mm_and_si128(pairs, _mm_set1_epi16(0x00FF));
+        uint64_t w;
+        _mm_storel_epi64((__m128i *)&w, _mm_packus_epi16(pairs, pairs));
+
+        uint64_t val = ffs_bswap64(w) >> (4 * (16 - n));
+        if (n < 16) {
+            *out = val;
+            return p + n;
+        }
+        /* 17+ digits: only fine with leading zeros, let the loop decide */
+        return ffs_parse_hex_scalar(p + 16, end, val, out);
+    }
+#endif
+    return ffs_parse_hex_scalar(p, end, 0, out);
+}
+
+/* Skips a run of hex digits without converting it */
+static inline const char *ffs_skip_hex(const char *p, const char *end)
+{
+    while (p < end && ffs_hex_table[(unsigned char)*p] >= 0) p++;
+    return p;
+}
+
+/* ============== Floating point ============== */
+
+/* 64x64 -> 128-bit product; returns the low half */
+static inline uint64_t ffs_mul128(uint64_t a, uint64_t b, uint64_t *hi)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, hi);
+#else
+    uint64_t aLo = (uint32_t)a, aHi = a >> 32;
+    uint64_t bLo = (uint32_t)b, bHi = b >> 32;
+    uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (uint32_t)ll;
+#endif
+}
+
+/* Count leading zero bits, x != 0 */
+static inline int ffs_clz64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return 63 - (int)idx;
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    if (_BitScanReverse(&idx, (unsigned long)(x >> 32))) return 31 - (int)idx;
+    _BitScanReverse(&idx, (unsigned long)x);
+    return 63 - (int)idx;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+/* A decimal number w * 10^q as read from the text */
+typedef struct {
+    uint64_t w;         /* first 19 significant digits */
+    int64_t  q;         /* decimal exponent */
+    int      neg;       /* leading '-' */
+    int      truncated; /* more non-zero digits than fit in w */
+} ffs_decimal;
+
+/* Reads [+-]digits[.digits][(e|E)[+-]digits] starting at p (at least one
+   mantissa digit). Returns a pointer past the number, or NULL if there is
+   none. An 'e' without exponent digits is not consumed, like strtod. */
+static inline const char *ffs_scan_decimal(const char *p, const char *end, ffs_decimal *d)
+{
+    d->neg = 0;
+    d->truncated = 0;
+    if (p < end && (*p == '+' || *p == '-')) {
+        d->neg = (*p == '-');
+        p++;
+    }
+
+    /* common case: at most 19 digits in total, both runs via the SWAR kernel */
+    const char *intEnd, *fracEnd = NULL;
+    uint64_t ival = 0, fval = 0;
+    intEnd = ffs_parse_u64(p, end, &ival);
+    if (intEnd && intEnd - p <= 19) {
+        fracEnd = intEnd;
+        if (intEnd < end && *intEnd == '.') {
+            fracEnd = ffs_parse_u64(intEnd + 1, end, &fval);
+            if (fracEnd && (intEnd - p) + (fracEnd - intEnd - 1) > 19)
+                fracEnd = NULL;
+        }
+    }
+    if (fracEnd) {
+        int intDigits  = (int)(intEnd - p);
+        int fracDigits = (fracEnd > intEnd) ? (int)(fracEnd - intEnd - 1) : 0;
+        if (intDigits + fracDigits == 0) return NULL;
+        d->w = ival * ffs_pow10_u64[fracDigits] + fval;
+        d->q = -fracDigits;
+        p = fracEnd;
+    } else {
+        /* long mantissa: keep 19 significant digits, note whether any
+           non-zero digit was dropped */
+        uint64_t w = 0;
+        int64_t  q = 0;
+        int sig = 0, any = 0;
+        while (p < end && (unsigned char)(*p - '0') <= 9) {
+            if (sig == 0 && *p == '0') {
+                /* leading zero */
+            } else if (sig < 19) {
+                w = w * 10 + (uint64_t)(*p - '0');
+                sig++;
+            } else {
+                q++;
+                if (*p != '0') d->truncated = 1;
+            }
+            any = 1;
+            p++;
+        }
+        if (p < end && *p == '.') {
+            p++;
+            while (p < end && (unsigned char)(*p - '0') <= 9) {
+                if (sig == 0 && *p == '0') {
+                    q--;
+                } else if (sig < 19) {
+                    w = w * 10 + (uint64_t)(*p - '0');
+                    sig++;
+                    q--;
+                } else if (*p != '0') {
+                    d->truncated = 1;
+                }
+                any = 1;
+                p++;
+            }
+        }
+        if (!any) return NULL;
+        d->w = w;
+        d->q = q;
+    }
+
+    if (p < end && (*p | 0x20) == 'e') {
+        const char *e = p + 1;
+        int eneg = 0;
+        if (e < end && (*e == '+' || *e == '-')) {
+            eneg = (*e == '-');
+            e++;
+        }
+        if (e < end && (unsigned char)(*e - '0') <= 9) {
+            int64_t ev = 0;
+            while (e < end && (unsigned char)(*e - '0') <= 9) {
+                if (ev < 100000) ev = ev * 10 + (*e - '0');
+                e++;
+            }
+            d->q += eneg ? -ev : ev;
+            p = e;
+        }
+    }
+    return p;
+}
+
+/* Binary format parameters for the Eisel-Lemire step */
+typedef struct {
+    int mantissaBits;     /* explicit mantissa bits */
+    int minExponent;      /* -bias */
+    int infinitePower;    /* biased exponent of inf */
+    int smallestPow10;    /* below: rounds to zero */
+    int largestPow10;     /* above: rounds to inf */
+    int minRoundToEven;   /* q range where exact halfway cases can occur */
+    int maxRoundToEven;
+} ffs_binary_format;
+
+static const ffs_binary_format ffs_binary64 = { 52, -1023, 0x7FF, -342, 308, -4, 23 };
+static const ffs_binary_format ffs_binary32 = { 23, -127, 0xFF, -65, 38, -17, 10 };
+
+/* Eisel-Lemire: correctly rounded w * 10^q (w exact) as mantissa bits and a
+   biased exponent. The 128-bit truncated power of five is always enough for
+   an exact w (Mushtak & Lemire, "Fast Number Parsing Without Fallback"). */
+static inline void ffs_eisel_lemire(int64_t q, uint64_t w, const ffs_binary_format *f,
+                                    uint64_t *mantissa, int *power2)
+{
+    if (w == 0 || q < f->smallestPow10) {
+        *mantissa = 0;
+        *power2 = 0;
+        return;
+    }
+    if (q > f->largestPow10) {
+        *mantissa = 0;
+        *power2 = f->infinitePower;
+        return;
+    }
+
+    int lz = ffs_clz64(w);
+    w <<= lz;
+
+    /* w * 5^q, second table word only when the first product is too close
+       to call */
+    size_t idx = 2 * (size_t)(q - FFS_POW5_MIN_Q);
+    uint64_t hi, lo = ffs_mul128(w, ffs_pow5_128[idx], &hi);
+    uint64_t precisionMask = 0xFFFFFFFFFFFFFFFFULL >> (f->mantissaBits + 3);
+    if ((hi & precisionMask) == precisionMask) {
+        uint64_t hi2;
+        ffs_mul128(w, ffs_pow5_128[idx + 1], &hi2);
+        lo += hi2;
+        if (hi2 > lo) hi++;
+    }
+
+    int upperBit = (int)(hi >> 63);
+    int shift = upperBit + 64 - f->mantissaBits - 3;
+    uint64_t m = hi >> shift;
+    /* floor(log2(10^q)) + 63 */
+    int p2 = (int)(((152170 + 65536) * (int32_t)q) >> 16) + 63 + upperBit - lz - f->minExponent;
+
+    if (p2 <= 0) {
+        /* subnormal */
+        if (-p2 + 1 >= 64) {
+            *mantissa = 0;
+            *power2 = 0;
+            return;
+        }
+        m >>= -p2 + 1;
+        m += (m & 1);
+        m >>= 1;
+        *mantissa = m;
+        *power2 = (m < (1ULL << f->mantissaBits)) ? 0 : 1;
+        return;
+    }
+
+    /* exactly halfway: round to even instead of up */
+    if (lo <= 1 && q >= f->minRoundToEven && q <= f->maxRoundToEven &&
+        (m & 3) == 1 && (m << shift) == hi) {
+        m &= ~1ULL;
+    }
+    m += (m & 1);
+    m >>= 1;
+    if (m >= (2ULL << f->mantissaBits)) {
+        m = 1ULL << f->mantissaBits;
+        p2++;
+    }
+    m &= ~(1ULL << f->mantissaBits);
+    if (p2 >= f->infinitePower) {
+        m = 0;
+        p2 = f->infinitePower;
+    }
+    *mantissa = m;
+    *power2 = p2;
+}
+
+/* Slow path: strtod/strtof/strtold on a NUL-terminated copy of [p, p+len).
+   Returns the number of characters the C library consumed. */
+static inline size_t ffs_strto_copy(const char *p, size_t len, int kind, void *out)
+{
+    char local[128];
+    char *tok = (len < sizeof(local)) ? local : (char *)malloc(len + 1);
+    if (!tok) return 0;
+    memcpy(tok, p, len);
+    tok[len] = '\0';
+    char *endp = tok;
+    if (kind == 0)      *(float *)out       = strtof(tok, &endp);
+    else if (kind == 1) *(double *)out      = strtod(tok, &endp);
+    else                *(long double *)out = strtold(tok, &endp);
+    size_t used = (size_t)(endp - tok);
+    if (tok != local) free(tok);
+    return used;
+}
+
+/* inf, nan and hex floats are left to the C library: hand it a bounded copy
+   of what follows (64 characters is plenty for those spellings) */
+static inline const char *ffs_parse_special(const char *p, const char *end, int kind, void *out)
+{
+    size_t avail = (size_t)(end - p);
+    size_t used = ffs_strto_copy(p, avail < 64 ? avail : 64, kind, out);
+    return used ? p + used : NULL;
+}
+
+/* Is this a spelling the decimal scanner does not handle? */
+static inline int ffs_is_special(const char *p, const char *end)
+{
+    if (p < end && (*p == '+' || *p == '-')) p++;
+    if (p >= end) return 0;
+    char c = (char)(*p | 0x20);
+    if (c == 'i' || c == 'n') return 1;
+    return (end - p > 1 && *p == '0' && (p[1] | 0x20) == 'x');
+}
+
+/* Skips a floating-point number without converting it: the syntax of
+   ffs_scan_decimal (sign, digits, '.', digits, exponent). The rare
+   inf/nan/hex spellings are measured by converting them. Returns NULL when
+   there is no number. */
+static inline const char *ffs_skip_float(const char *p, const char *end)
+{
+    if (ffs_is_special(p, end)) {
+        long double discard;
+        return ffs_parse_special(p, end, 2, &discard);
+    }
+    if (p < end && (*p == '+' || *p == '-')) p++;
+    const char *q = ffs_skip_digits(p, end);
+    size_t digits = (size_t)(q - p);
+    if (q < end && *q == '.') {
+        const char *f = q + 1;
+        q = ffs_skip_digits(f, end);
+        digits += (size_t)(q - f);
+    }
+    if (digits == 0) return NULL;
+    if (q < end && (*q | 0x20) == 'e') {
+        const char *e = q + 1;
+        if (e < end && (*e == '+' || *e == '-')) e++;
+        const char *x = ffs_skip_digits(e, end);
+        if (x > e) q = x;
+    }
+    return q;
+}
+
+/* Exact powers of ten for the Clinger fast path */
+static const double ffs_pow10_f64[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const float ffs_pow10_f32[11] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/* Parses a decimal floating-point number into a double, correctly rounded.
+   Returns a pointer past the number, or NULL if there is none. */
+static inline const char *ffs_parse_double(const char *p, const char *end, double *out)
+{
+    if (ffs_is_special(p, end)) return ffs_parse_special(p, end, 1, out);
+
+    ffs_decimal d;
+    const char *q = ffs_scan_decimal(p, end, &d);
+    if (!q) return NULL;
+
+#if FLT_EVAL_METHOD == 0
+    /* Clinger: w and 10^|q| are both exact doubles, one rounding */
+    if (!d.truncated && d.w <= (1ULL << 53) && d.q >= -22 && d.q <= 22) {
+        double v = (double)d.w;
+        v = (d.q < 0) ? v / ffs_pow10_f64[-d.q] : v * ffs_pow10_f64[d.q];
+        *out = d.neg ? -v : v;
+        return q;
+    }
+#endif
+
+    uint64_t m;
+    int p2;
+    ffs_eisel_lemire(d.q, d.w, &ffs_binary64, &m, &p2);
+    if (d.truncated) {
+        /* the true value lies between w and w+1: fine if both agree */
+        uint64_t m1;
+        int p21;
+        ffs_eisel_lemire(d.q, d.w + 1, &ffs_binary64, &m1, &p21);
+        if (m != m1 || p2 != p21) {
+            return ffs_strto_copy(p, (size_t)(q - p), 1, out) ? q : NULL;
+        }
+    }
+    uint64_t bits = m | ((uint64_t)p2 << 52) | ((uint64_t)d.neg << 63);
+    memcpy(out, &bits, sizeof(bits));
+    return q;
+}
+
+/* Same for float, rounded once straight to binary32 */
+static inline const char *ffs_parse_float(const char *p, const char *end, float *out)
+{
+    if (ffs_is_special(p, end)) return ffs_parse_special(p, end, 0, out);
+
+    ffs_decimal d;
+    const char *q = ffs_scan_decimal(p, end, &d);
+    if (!q) return NULL;
+
+#if FLT_EVAL_METHOD == 0
+    if (!d.truncated && d.w <= (1ULL << 24) && d.q >= -10 && d.q <= 10) {
+        float v = (float)d.w;
+        v = (d.q < 0) ? v / ffs_pow10_f32[-d.q] : v * ffs_pow10_f32[d.q];
+        *out = d.neg ? -v : v;
+        return q;
+    }
+#endif
+
+    uint64_t m;
+    int p2;
+    ffs_eisel_lemire(d.q, d.w, &ffs_binary32, &m, &p2);
+    if (d.truncated) {
+        uint64_t m1;
+        int p21;
+        ffs_eisel_lemire(d.q, d.w + 1, &ffs_binary32, &m1, &p21);
+        if (m != m1 || p2 != p21) {
+            return ffs_strto_copy(p, (size_t)(q - p), 0, out) ? q : NULL;
+        }
+    }
+    uint32_t bits = (uint32_t)m | ((uint32_t)p2 << 23) | ((uint32_t)d.neg << 31);
+    memcpy(out, &bits, sizeof(bits));
+    return q;
+}
+
+/* ============== Long double ==============
+
+   strtold is locale-aware and arbitrary-precision. For the usual short
+   decimal (w < 2^64, few fraction digits) the value is w * 10^q with both
+   factors exact in long double, so a single multiply or divide is already
+   correctly rounded (Clinger). FFS_LDBL_MAX_POW10 is the largest q with
+   5^q < 2^LDBL_MANT_DIG. */
+#if LDBL_MANT_DIG == 64 && !defined(_WIN32)
+#define FFS_LDBL_MAX_POW10 27      /* x87 extended; Windows runs the x87 at 53 bits */
+#elif LDBL_MANT_DIG == 113
+#define FFS_LDBL_MAX_POW10 48      /* IEEE quad */
+#else
+#define FFS_LDBL_MAX_POW10 0       /* no exact fast path */
+#endif
+
+#if FFS_LDBL_MAX_POW10 > 0
+static const long double ffs_pow10_ldbl[49] = {
+    1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L,
+    1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L,
+    1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L,
+    1e24L, 1e25L, 1e26L, 1e27L, 1e28L, 1e29L, 1e30L, 1e31L,
+    1e32L, 1e33L, 1e34L, 1e35L, 1e36L, 1e37L, 1e38L, 1e39L,
+    1e40L, 1e41L, 1e42L, 1e43L, 1e44L, 1e45L, 1e46L, 1e47L,
+    1e48L
+};
+#endif
+
+/* Clinger step on a scanned decimal: 1 and *out set when the result is
+   known to be correctly rounded, 0 otherwise. */
+static inline int ffs_long_double_exact(const ffs_decimal *d, long double *out)
+{
+#if FFS_LDBL_MAX_POW10 > 0
+    if (d->truncated) return 0;
+    int q = d->q;
+    if (q < -FFS_LDBL_MAX_POW10 || q > FFS_LDBL_MAX_POW10) {
+        if (d->w != 0) return 0;
+        q = 0;
+    }
+    long double v = (long double)d->w;
+    v = (q < 0) ? v / ffs_pow10_ldbl[-q] : v * ffs_pow10_ldbl[q];
+    *out = d->neg ? -v : v;
+    return 1;
+#else
+    (void)d; (void)out;
+    return 0;
+#endif
+}
+
+/* Exact long double fast path. Returns a pointer past the number, or NULL
+   when exactness cannot be guaranteed (or there is no number): the caller
+   then has to use ffs_parse_long_double or strtold. */
+static inline const char *ffs_parse_long_double_fast(const char *p, const char *end,
+                                                     long double *out)
+{
+    if (ffs_is_special(p, end)) return NULL;
+    ffs_decimal d;
+    const char *q = ffs_scan_decimal(p, end, &d);
+    return (q && ffs_long_double_exact(&d, out)) ? q : NULL;
+}
+
+/* Parses a decimal number into a long double: the exact fast path when it
+   applies, strtold on a copy of the token otherwise. Where long double is
+   just double (MSVC), this is ffs_parse_double. */
+static inline const char *ffs_parse_long_double(const char *p, const char *end, long double *out)
+{
+#if LDBL_MANT_DIG == DBL_MANT_DIG
+    double v;
+    const char *q = ffs_parse_double(p, end, &v);
+    if (q) *out = v;
+    return q;
+#else
+    if (ffs_is_special(p, end)) return ffs_parse_special(p, end, 2, out);
+    ffs_decimal d;
+    const char *q = ffs_scan_decimal(p, end, &d);
+    if (!q) return NULL;
+    if (ffs_long_double_exact(&d, out)) return q;
+    return ffs_strto_copy(p, (size_t)(q - p), 2, out) ? q : NULL;
+#endif
+}
+
+/* ============== Line boundaries ==============
+
+   Stage-1 scan in the style of simdjson's structural index: compare a 64-byte
+   block against the character, turn the result into a bit mask and walk its
+   set bits. AVX2 does a block with two 32-byte compares, SSE2 with four
+   16-byte ones; the tail and other targets use a scalar loop. */
+
+#if FFS_AVX2 || FFS_SSE2
+/* Bit i is set when p[i] == c, for the 64 bytes at p */
+static inline uint64_t ffs_match_mask64(const char *p, char c)
+{
+#if FFS_AVX2
+    __m256i n  = _mm256_set1_epi8(c);
+    uint32_t lo = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), n));
+    uint32_t hi = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 32)), n));
+    return (uint64_t)lo | ((uint64_t)hi << 32);
+#else
+    __m128i n = _mm_set1_epi8(c);
+    uint64_t m0 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), n));
+    uint64_t m1 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), n));
+    uint64_t m2 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), n));
+    uint64_t m3 = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), n));
+    return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+#endif
+}
+#endif
+
+/* First occurrence of c in [p, end), or end */
+static inline const char *ffs_find_char(const char *p, const char *end, char c)
+{
+#if FFS_AVX2 || FFS_SSE2
+    /* over-reads: the last block runs into the padding */
+    for (; p < end; p += 64) {
+        uint64_t m = ffs_match_mask64(p, c);
+        if (m) {
+            p += ffs_ctz64(m);
+            return (p < end) ? p : end;
+        }
+    }
+    return end;
+#else
+    while (p < end && *p != c) p++;
+    return p;
+#endif
+}
+
+/* Offsets of the line starts of buf[0 .. size): 0, then every position just
+   after a '\n' that is still inside the buffer. The first 'cap' of them are
+   stored in starts (which may be NULL when cap is 0); the return value is
+   the total number of lines, so a first call with cap 0 sizes the array. */
+static inline size_t ffs_index_lines(const char *buf, size_t size, size_t *starts, size_t cap)
+{
+    if (size == 0) return 0;
+    if (cap) starts[0] = 0;
+    size_t n = 1;
+    size_t i = 0;
+#if FFS_AVX2 || FFS_SSE2
+    for (; size - i >= 64; i += 64) {
+        uint64_t m = ffs_match_mask64(buf + i, '\n');
+        while (m) {
+            if (n < cap) starts[n] = i + (size_t)ffs_ctz64(m) + 1;
+            n++;
+            m &= m - 1;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (buf[i] == '\n') {
+            if (n < cap) starts[n] = i + 1;
+            n++;
+        }
+    }
+    /* a final '\n' does not start another line */
+    if (buf[size - 1] == '\n') n--;
+    return n;
+}
+
+#endif /* FFS_KERNELS_H */
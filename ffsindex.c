@@ -0,0 +1,78 @@
+/* ffsindex.c - builds <file>.idx and prints records by number through it
+ *
+ *   ffsindex <file>                   build (or refresh) <file>.idx
+ *   ffsindex <file> <first> [count]   print lines first .. first+count-1
+ *
+ * Build: gcc -O2 ffsindex.c line_index.c -o ffsindex
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "line_index.h"
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "usage: %s <file> [<first> [count]]\n", argv[0]);
+        return 2;
+    }
+    const char *filename = argv[1];
+
+    if (argc == 2) {
+        if (!line_index_build(filename)) {
+            fprintf(stderr, "cannot index %s\n", filename);
+            return 1;
+        }
+        LineIndex *idx = line_index_open(filename, FALSE);
+        if (!idx) {
+            fprintf(stderr, "cannot load the index of %s\n", filename);
+            return 1;
+        }
+        printf("%s.idx: %zu lines\n", filename, line_index_count(idx));
+        line_index_close(idx);
+        return 0;
+    }
+
+    size_t first = (size_t)strtoull(argv[2], NULL, 10);
+    size_t count = (argc > 3) ? (size_t)strtoull(argv[3], NULL, 10) : 1;
+    LineIndex *idx = line_index_open(filename, TRUE);
+    if (!idx) {
+        fprintf(stderr, "cannot index %s\n", filename);
+        return 1;
+    }
+    size_t begin, end;
+    if (!line_index_range(idx, first, count, &begin, &end)) {
+        if (first < line_index_count(idx))
+            fprintf(stderr, "%s.idx is corrupt\n", filename);
+        else
+            fprintf(stderr, "%s has %zu lines\n", filename, line_index_count(idx));
+        line_index_close(idx);
+        return 1;
+    }
+    line_index_close(idx);
+
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        perror("fopen");
+        return 1;
+    }
+#ifdef _WIN32
+    int sought = _fseeki64(fp, (long long)begin, SEEK_SET);
+#else
+    int sought = fseeko(fp, (off_t)begin, SEEK_SET);
+#endif
+    if (sought != 0) {
+        perror("fseek");
+        fclose(fp);
+        return 1;
+    }
+    char buf[65536];
+    size_t left = end - begin;
+    while (left > 0) {
+        size_t rd = fread(buf, 1, left < sizeof(buf) ? left : sizeof(buf), fp);
+        if (rd == 0) break;
+        fwrite(buf, 1, rd, stdout);
+        left -= rd;
+    }
+    fclose(fp);
+    return 0;
+}
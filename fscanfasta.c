@@ -1,65 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include <limits.h>
 #include <time.h>
 #include <errno.h>
 
-extern int fast_fscanf_mem(
-    const char *buffer, size_t size,
-    size_t *offset,
-    const char *format, ...
-);
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-/* Boolean type for better readability */
-typedef int BOOL;
-#define TRUE 1
-#define FALSE 0
-
-/* I/O structure that handles both file and memory-based operations */
-typedef struct {
-    FILE *fp;          /* File pointer (file mode) */
-    char *buffer;      /* Memory buffer (memory mode) */
-    char *ptr;         /* Current position in buffer */
-    char *end;         /* End of buffer */
-    size_t size;       /* Buffer size */
-    BOOL useFile;      /* Mode flag (TRUE = file, FALSE = memory) */
-} MyIO;
-
-/* Date structure (g=day, m=month, a=year) */
-struct data {
-    char g;
-    char m;
-    short a;
-};
-
-/* Time structure (o=hour, m=minute, s=second) */
-struct ora {
-    char o;
-    char m;
-    char s;
-};
-
-/* Test record structure with various field types */
-typedef struct {
-    unsigned long pn_prog;      /* Progressive number */
-    short pn_n;                 /* Secondary identifier */
-    short field_short;          
-    unsigned short field_ushort;
-    int field_int;              
-    unsigned short field_hexushort; /* Hex format */
-    unsigned long field_hexulong;   /* Hex format */
-    float field_float;          
-    long double field_ldouble;  
-    char token[64];             /* String token */
-    short day, month, year;     /* Date components */
-    short hour, minute, second; /* Time components */
-} Record;
+#include "fscanfasta.h"
+#include "fast_fscanf.h"
+#include "line_index.h"
+#include "record_cache.h"
+#include "ffs_kernels.h"
+#include "bench.h"
 
 /* ============== I/O basic functions ============== */
 
-/* Loads entire file into memory buffer
+/* The kernels may read FFS_PADDING bytes past the end of the data */
+typedef char ioPaddingCheck[(IO_PADDING >= FFS_PADDING) ? 1 : -1];
+
+/* Loads entire file into memory buffer, followed by IO_PADDING zero bytes
    Returns TRUE on success, FALSE on failure */
 BOOL loadFileIntoBuffer(FILE *fp, const char *filename, MyIO *io, BOOL loadBuffer) {
     if (!loadBuffer) return FALSE;
@@ -69,13 +36,13 @@ BOOL loadFileIntoBuffer(FILE *fp, const char *filename, MyIO *io, BOOL loadBuffe
     fseek(fp, 0, SEEK_END);
     long fileSize = ftell(fp);
     fseek(fp, 0, SEEK_SET);
-    io->buffer = (char*)malloc(fileSize + 1);
+    io->buffer = (char*)malloc(fileSize + IO_PADDING);
     if (!io->buffer) {
         fclose(fp);
         return FALSE;
     }
     size_t rd = fread(io->buffer, 1, fileSize, fp);
-    io->buffer[rd] = '\0';
+    memset(io->buffer + rd, 0, IO_PADDING);
     io->size = rd;
     fclose(fp);
     io->ptr = io->buffer;
@@ -101,14 +68,257 @@ BOOL ioOpen(MyIO *io, const char *filename, BOOL readAllInMemory) {
     return TRUE;
 }
 
-/* Closes file or frees memory */
+/* Maps a whole file read-only for sequential parsing.
+   The mapping is always followed by at least IO_PADDING zero bytes, like
+   the buffer of loadFileIntoBuffer: on POSIX the file is mapped over an
+   anonymous reservation one page longer than the file. On Windows the zeros
+   are the rest of the last page, so a file that ends less than IO_PADDING
+   bytes before a page boundary cannot be mapped and NULL is returned, as on
+   any error. flags are IO_MAP_*; they are hints and are ignored where
+   the platform lacks them. Release with ioUnmapFile(base, *size). */
+char *ioMapFile(const char *filename, unsigned flags, size_t *size) {
+    if (!filename || !size) return NULL;
+#ifdef _WIN32
+    (void)flags;
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER fsize;
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    if (!GetFileSizeEx(file, &fsize) || fsize.QuadPart == 0 ||
+        fsize.QuadPart % si.dwPageSize == 0 ||
+        fsize.QuadPart % si.dwPageSize > si.dwPageSize - IO_PADDING) {
+        CloseHandle(file);
+        return NULL;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return NULL;
+    char *base = (char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!base) return NULL;
+    *size = (size_t)fsize.QuadPart;
+    return base;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t fsize = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t reserve = (fsize + page - 1) / page * page + page;
+
+    char *base = (char*)mmap(NULL, reserve, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == (char*)MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (fsize > 0) {
+        int mflags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+        if (flags & IO_MAP_POPULATE) mflags |= MAP_POPULATE;
+#endif
+        if (mmap(base, fsize, PROT_READ, mflags, fd, 0) == MAP_FAILED) {
+            munmap(base, reserve);
+            close(fd);
+            return NULL;
+        }
+#ifdef MADV_SEQUENTIAL
+        madvise(base, fsize, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_HUGEPAGE
+        /* only honoured for page-cache files when the kernel has THP for file mappings */
+        if (flags & IO_MAP_HUGEPAGES) madvise(base, fsize, MADV_HUGEPAGE);
+#endif
+    }
+    (void)flags;
+    close(fd);
+    *size = fsize;
+    return base;
+#endif
+}
+
+/* Releases a mapping returned by ioMapFile */
+void ioUnmapFile(char *base, size_t size) {
+    if (!base) return;
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(base);
+#else
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    munmap(base, (size + page - 1) / page * page + page);
+#endif
+}
+
+/* Opens file in memory mode on top of a read-only mapping: parsing can start
+   before the whole file has been read and the pages are shared with the page
+   cache. Falls back to loadFileIntoBuffer when the file cannot be mapped.
+   Returns TRUE on success, FALSE on failure */
+BOOL ioOpenMapped(MyIO *io, const char *filename, unsigned flags) {
+    memset(io, 0, sizeof(*io));
+    if (!filename) return FALSE;
+    io->buffer = ioMapFile(filename, flags, &io->size);
+    if (!io->buffer)
+        return loadFileIntoBuffer(NULL, filename, io, TRUE);
+    io->mapped = TRUE;
+    io->ptr = io->buffer;
+    io->end = io->buffer + io->size;
+    return TRUE;
+}
+
+/* Streaming state: two chunk buffers used in turn. The window handed to the
+   readers, [ptr, end), always stops after the last complete line; the
+   partial line behind it is carried over to the other buffer by ioRefill,
+   which leaves the previous window intact until the next refill. To keep
+   it so, a buffer only grows when it is about to be filled again. */
+typedef struct {
+    FILE *fp;
+    char *buf[2];
+    size_t cap[2];     /* capacity of each buffer (plus IO_PADDING zero bytes) */
+    int cur;           /* buffer holding the current window */
+    size_t window;     /* bytes per window, the larger of the capacities */
+    size_t fill;       /* bytes valid in buf[cur] */
+    BOOL eof;
+    BOOL error;        /* read error or no memory to grow a window */
+} IoStream;
+
+/* Opens file in streaming memory mode: the file is read in chunks of
+   'window' bytes (IO_STREAM_WINDOW when 0), so memory use is two windows
+   whatever the file size. A window only grows to fit a single line longer
+   than it. The memory-mode readers run unchanged: they refill at the end of
+   the window; C++ callers parse [ptr, end) and call ioRefill themselves.
+   Returns TRUE on success, FALSE on failure */
+BOOL ioOpenStream(MyIO *io, const char *filename, size_t window) {
+    memset(io, 0, sizeof(*io));
+    if (!filename) return FALSE;
+    if (window == 0) window = IO_STREAM_WINDOW;
+    IoStream *s = (IoStream*)calloc(1, sizeof(IoStream));
+    if (!s) return FALSE;
+    s->fp = fopen(filename, "rb");
+    s->buf[0] = (char*)malloc(window + IO_PADDING);
+    s->buf[1] = (char*)malloc(window + IO_PADDING);
+    if (!s->fp || !s->buf[0] || !s->buf[1]) {
+        if (s->fp) fclose(s->fp);
+        free(s->buf[0]);
+        free(s->buf[1]);
+        free(s);
+        return FALSE;
+    }
+    setvbuf(s->fp, NULL, _IONBF, 0);  /* chunks go straight into our buffers */
+    s->cap[0] = s->cap[1] = s->window = window;
+    io->stream = s;
+    io->buffer = io->ptr = io->end = s->buf[0];
+    ioRefill(io);
+    return TRUE;
+}
+
+/* Slides a streaming window: whatever is left of it, [ptr, end) and the
+   partial line behind it, is carried over to the other buffer and the next
+   chunk is read after it. Returns TRUE if there is new data in [ptr, end),
+   FALSE at end of file, on an error (see ioStreamError) and for
+   non-streaming MyIO */
+BOOL ioRefill(MyIO *io) {
+    IoStream *s = (IoStream*)io->stream;
+    if (!s || s->error) return FALSE;
+    char *data = s->buf[s->cur] + s->fill;
+    if (s->eof && io->end == data) return FALSE;   /* all handed out already */
+
+    /* the other buffer is free: catch up with a window grown since it was
+       last filled, the carry may be that large */
+    int other = s->cur ^ 1;
+    if (s->cap[other] < s->window) {
+        char *b = (char*)realloc(s->buf[other], s->window + IO_PADDING);
+        if (!b) {
+            fprintf(stderr, "ioRefill: out of memory for a %zu byte window\n", s->window);
+            s->error = TRUE;
+            return FALSE;
+        }
+        s->buf[other] = b;
+        s->cap[other] = s->window;
+    }
+    size_t carry = (size_t)(data - io->ptr);
+    char *next = s->buf[other];
+    memcpy(next, io->ptr, carry);
+    size_t fill = carry;
+    char *end;
+    for (;;) {
+        if (!s->eof) {
+            size_t rd = fread(next + fill, 1, s->window - fill, s->fp);
+            if (rd < s->window - fill) {
+                s->eof = TRUE;
+                if (ferror(s->fp)) {
+                    fprintf(stderr, "ioRefill: read error\n");
+                    s->error = TRUE;
+                    return FALSE;
+                }
+            }
+            fill += rd;
+#if defined(POSIX_FADV_WILLNEED) && !defined(_WIN32)
+            /* start reading the following chunk while this one is parsed */
+            posix_fadvise(fileno(s->fp), ftell(s->fp), (off_t)s->window, POSIX_FADV_WILLNEED);
+#endif
+        }
+        end = next + fill;
+        while (end > next && end[-1] != '\n') end--;
+        if (s->eof || (end > next && fill > carry)) break;
+
+        /* one line longer than the window, or a carry the caller could not
+           consume that fills the whole window: grow this buffer only, the
+           current window may still be referenced (ioReadTokenView) */
+        size_t grown = s->window * 2;
+        char *b = (char*)realloc(next, grown + IO_PADDING);
+        if (!b) {
+            fprintf(stderr, "ioRefill: out of memory for a %zu byte window\n", grown);
+            s->error = TRUE;
+            return FALSE;
+        }
+        s->buf[other] = next = b;
+        s->cap[other] = s->window = grown;
+    }
+    if (s->eof) end = next + fill;    /* last line may lack its '\n' */
+    memset(next + fill, 0, IO_PADDING);
+
+    s->cur = other;
+    s->fill = fill;
+    io->buffer = io->ptr = next;
+    io->end = end;
+    io->size = (size_t)(end - next);
+    return (end > next);
+}
+
+/* TRUE when a streaming MyIO stopped on a read error or for lack of memory
+   rather than at end of file */
+BOOL ioStreamError(const MyIO *io) {
+    const IoStream *s = (const IoStream*)io->stream;
+    return s && s->error;
+}
+
+/* Closes file, frees memory or unmaps the file */
 void ioClose(MyIO *io) {
-    if (io->useFile) {
+    if (io->stream) {
+        IoStream *s = (IoStream*)io->stream;
+        fclose(s->fp);
+        free(s->buf[0]);
+        free(s->buf[1]);
+        free(s);
+        io->stream = NULL;
+        io->buffer = NULL;
+    }
+    else if (io->useFile) {
         if (io->fp) {
             fclose(io->fp);
             io->fp = NULL;
         }
     }
+    else if (io->mapped) {
+        ioUnmapFile(io->buffer, io->size);
+        io->buffer = NULL;
+        io->mapped = FALSE;
+    }
     else {
         if (io->buffer) {
             free(io->buffer);
@@ -126,13 +336,13 @@ BOOL ioSkipLine(MyIO *io) {
         return (c != EOF);
     }
     else {
-        while (io->ptr < io->end && *io->ptr != '\n') {
-            io->ptr++;
-        }
+        if (io->ptr >= io->end && !ioRefill(io))
+            return FALSE;
+        io->ptr = (char*)ffs_find_char(io->ptr, io->end, '\n');
         if (io->ptr < io->end && *io->ptr == '\n') {
             io->ptr++;
         }
-        return (io->ptr < io->end);
+        return (io->ptr < io->end || ioRefill(io));
     }
 }
 
@@ -144,8 +354,7 @@ BOOL ioReadShort(MyIO *io, short *out) {
         return (ret == 1);
     }
     else {
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
         char *endp;
         long val = strtol(io->ptr, &endp, 10);
@@ -168,8 +377,7 @@ BOOL ioReadUShort(MyIO *io, unsigned short *out) {
     }
     else {
         if (!out) return FALSE;
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
         char *endp;
         unsigned long val = strtoul(io->ptr, &endp, 10);
@@ -192,8 +400,7 @@ BOOL ioReadInt(MyIO *io, int *out) {
     }
     else {
         if (!out) return FALSE;
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
         char *endp;
         long val = strtol(io->ptr, &endp, 10);
@@ -207,6 +414,23 @@ BOOL ioReadInt(MyIO *io, int *out) {
     }
 }
 
+/* Parses a hex number at io->ptr with the SIMD hex kernel; like strtoul,
+   an optional "0x"/"0X" prefix is accepted */
+static BOOL ioParseHex(MyIO *io, unsigned long *out) {
+    const char *p = io->ptr;
+    if (io->end - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && ffs_hex_value(p[2]) >= 0)
+        p += 2;
+    uint64_t val;
+    const char *endp = ffs_parse_hex_u64(p, io->end, &val);
+    if (!endp || endp == p)
+        return FALSE;
+    if (val > ULONG_MAX)
+        return FALSE;
+    *out = (unsigned long)val;
+    io->ptr = (char*)endp;
+    return TRUE;
+}
+
 /* Reads a hexadecimal unsigned short */
 BOOL ioReadHexUShort(MyIO *io, unsigned short *out) {
     if (io->useFile) {
@@ -221,17 +445,12 @@ BOOL ioReadHexUShort(MyIO *io, unsigned short *out) {
     }
     else {
         if (!out) return FALSE;
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
-        char *endp;
-        unsigned long val = strtoul(io->ptr, &endp, 16);
-        if (endp == io->ptr)
-            return FALSE;
-        if (endp > io->end)
+        unsigned long val;
+        if (!ioParseHex(io, &val))
             return FALSE;
         *out = (unsigned short)val;
-        io->ptr = endp;
         return TRUE;
     }
 }
@@ -245,18 +464,9 @@ BOOL ioReadHexULong(MyIO *io, unsigned long *out) {
     }
     else {
         if (!out) return FALSE;
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
-        char *endp;
-        unsigned long val = strtoul(io->ptr, &endp, 16);
-        if (endp == io->ptr)
-            return FALSE;
-        if (endp > io->end)
-            return FALSE;
-        *out = val;
-        io->ptr = endp;
-        return TRUE;
+        return ioParseHex(io, out);
     }
 }
 
@@ -272,7 +482,7 @@ BOOL ioReadChar(MyIO *io, char *out) {
     }
     else {
         if (!out) return FALSE;
-        if (io->ptr >= io->end) return FALSE;
+        if (io->ptr >= io->end && !ioRefill(io)) return FALSE;
         *out = *io->ptr;
         io->ptr++;
         return TRUE;
@@ -296,6 +506,17 @@ static void stripQuotes(char *str) {
     }
 }
 
+/* stripQuotes on a view: drops a leading and a trailing quote by moving
+   its bounds, nothing is copied */
+static void stripQuotesView(const char **str, size_t *len) {
+    if (*len > 0 && (**str == '\'' || **str == '\"')) {
+        (*str)++;
+        (*len)--;
+    }
+    if (*len > 0 && ((*str)[*len - 1] == '\'' || (*str)[*len - 1] == '\"'))
+        (*len)--;
+}
+
 /* Reads a string token */
 BOOL ioReadToken(MyIO *io, char *outBuffer, size_t maxLen) {
     if (!outBuffer || maxLen < 1) return FALSE;
@@ -309,21 +530,43 @@ BOOL ioReadToken(MyIO *io, char *outBuffer, size_t maxLen) {
         return FALSE;
     }
     else {
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end)
             return FALSE;
-        size_t i = 0;
-        while (io->ptr < io->end && !isspace((unsigned char)*io->ptr) && i < (maxLen - 1)) {
-            outBuffer[i++] = *io->ptr;
-            io->ptr++;
-        }
-        outBuffer[i] = '\0';
-        stripQuotes(outBuffer);
-        return (i > 0);
+        /* at most maxLen - 1 characters, found with the SIMD scan; the quotes
+           are stripped from the bounds, so the token is copied once */
+        const char *stop = ((size_t)(io->end - io->ptr) > maxLen - 1) ? io->ptr + (maxLen - 1) : io->end;
+        const char *tok = io->ptr;
+        const char *q = ffs_find_space(tok, stop);
+        size_t len = (size_t)(q - tok);
+        io->ptr = (char*)q;
+        if (len == 0)
+            return FALSE;
+        stripQuotesView(&tok, &len);
+        ffs_copy_bytes(outBuffer, tok, len);
+        outBuffer[len] = '\0';
+        return TRUE;
     }
 }
 
+/* Reads a string token as a view into the buffer: *token and *len are set
+   to the token with its quotes stripped, nothing is copied. Memory and
+   mapped modes only; in streaming mode the view is valid until the next
+   refill. Returns FALSE in file mode */
+BOOL ioReadTokenView(MyIO *io, const char **token, size_t *len) {
+    if (io->useFile) return FALSE;
+    io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
+    const char *tok = io->ptr;
+    const char *q = ffs_find_space(tok, io->end);
+    if (q == tok) return FALSE;
+    io->ptr = (char*)q;
+    size_t n = (size_t)(q - tok);
+    stripQuotesView(&tok, &n);
+    *token = tok;
+    *len = n;
+    return TRUE;
+}
+
 /* Reads a date in DD/MM/YYYY format */
 BOOL ioReadData(MyIO *io, struct data *pdata) {
     short gg, mm, aa;
@@ -366,15 +609,14 @@ BOOL ioReadFloat(MyIO *io, float *out) {
         return (ret == 1);
     }
     else {
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
-        char *endp;
-        float val = strtof(io->ptr, &endp);
-        if (endp == io->ptr || endp > io->end)
+        float val;
+        const char *endp = ffs_parse_float(io->ptr, io->end, &val);
+        if (!endp)
             return FALSE;
         *out = val;
-        io->ptr = endp;
+        io->ptr = (char*)endp;
         return TRUE;
     }
 }
@@ -387,21 +629,42 @@ BOOL ioReadLongDouble(MyIO *io, long double *out) {
         return (ret == 1);
     }
     else {
-        while (io->ptr < io->end && isspace((unsigned char)*io->ptr))
-            io->ptr++;
+        io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
         if (io->ptr >= io->end) return FALSE;
-        char *endp;
-        long double val = strtold(io->ptr, &endp);
-        if (endp == io->ptr || endp > io->end)
+        long double val;
+        const char *endp = ffs_parse_long_double(io->ptr, io->end, &val);
+        if (!endp)
             return FALSE;
         *out = val;
-        io->ptr = endp;
+        io->ptr = (char*)endp;
         return TRUE;
     }
 }
 
 /* ============== Record read functions ============== */
 
+/* Consumes the end of a record: trailing blanks and its '\n'.
+   Returns FALSE if something else follows the last field */
+static BOOL ioEndRecord(MyIO *io) {
+    char c;
+    // Consuma il carattere di newline; se siamo a fine file va bene
+    if (io->ptr < io->end) {
+        if (!ioReadChar(io, &c))
+            return FALSE;
+        // Se il carattere non è '\n', prova a saltare eventuali spazi fino al newline
+        while (c != '\n' && ffs_is_space(c)) {
+            if (io->ptr >= io->end)
+                break;
+            if (!ioReadChar(io, &c))
+                break;
+        }
+        // Se il carattere finale non è '\n' e non siamo a fine file, segnala errore
+        if (c != '\n' && io->ptr < io->end)
+            return FALSE;
+    }
+    return TRUE;
+}
+
 /* Reads a complete record using custom parsing functions
    Records follow format: :<hex>[<n>]( <fields...> <date> <time> 
    ps: pardon my italian comments, I was getting lost, I'm a noob */
@@ -435,186 +698,1592 @@ BOOL read_record_custom(MyIO *io, Record *rec) {
         rec->minute = o.m;
         rec->second = o.s;
     }
-    // Consuma il carattere di newline; se siamo a fine file va bene
-    if (io->ptr < io->end) {
-        if (!ioReadChar(io, &c))
-            return FALSE;
-        // Se il carattere non è '\n', prova a saltare eventuali spazi fino al newline
-        while (c != '\n' && isspace((unsigned char)c)) {
-            if (io->ptr >= io->end)
-                break;
-            if (!ioReadChar(io, &c))
-                break;
-        }
-        // Se il carattere finale non è '\n' e non siamo a fine file, segnala errore
-        if (c != '\n' && io->ptr < io->end)
-            return FALSE;
-    }
-    return TRUE;
+    return ioEndRecord(io);
 }
 
-/* ============== Test functions ============== */
-
-/* Creates test file with structured data of target_size bytes */
-void create_test_file(const char *filename, size_t target_size) {
-    FILE *f = fopen(filename, "w");
-    if (!f) {
-        perror("fopen");
-        exit(1);
+/* read_record_custom, with the token returned as a view into io's buffer
+   (ioReadTokenView) instead of being copied into the record */
+BOOL read_record_view(MyIO *io, RecordView *rec) {
+    char c;
+    if (!ioReadChar(io, &c) || c != ':') return FALSE;
+    if (!ioReadHexULong(io, &rec->pn_prog)) return FALSE;
+    if (!ioReadChar(io, &c) || c != '[') return FALSE;
+    if (!ioReadShort(io, &rec->pn_n)) return FALSE;
+    if (!ioReadChar(io, &c) || c != ']') return FALSE;
+    if (!ioReadChar(io, &c) || c != '(') return FALSE;
+    if (!ioReadShort(io, &rec->field_short)) return FALSE;
+    if (!ioReadUShort(io, &rec->field_ushort)) return FALSE;
+    if (!ioReadInt(io, &rec->field_int)) return FALSE;
+    if (!ioReadHexUShort(io, &rec->field_hexushort)) return FALSE;
+    if (!ioReadHexULong(io, &rec->field_hexulong)) return FALSE;
+    if (!ioReadFloat(io, &rec->field_float)) return FALSE;
+    if (!ioReadLongDouble(io, &rec->field_ldouble)) return FALSE;
+    if (!ioReadTokenView(io, &rec->token, &rec->token_len)) return FALSE;
+    {
+        struct data d;
+        if (!ioReadData(io, &d)) return FALSE;
+        rec->day = d.g;
+        rec->month = d.m;
+        rec->year = d.a;
     }
-    size_t total_written = 0;
-    unsigned long rec_no = 0;
-    while(total_written < target_size) {
-        int n = fprintf(f,
-            ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %s %02hd/%02hd/%04hd %02hd:%02hd:%02hd\n",
-            rec_no, (short)5,
-            (short)(rec_no % 32767), (unsigned short)(rec_no % 65535),
-            (int)rec_no, (unsigned short)(rec_no % 65535), rec_no,
-            (float)(rec_no * 0.1), (long double)(rec_no * 0.01),
-            "token",
-            (short)1, (short)1, (short)2020,
-            (short)(rec_no % 24), (short)(rec_no % 60), (short)(rec_no % 60)
-        );
-        if(n < 0)
-            break;
-        total_written += n;
-        rec_no++;
-        if(rec_no % 100000 == 0)
-            printf("%lu record created, %zu bytes written...\n", rec_no, total_written);
+    {
+        struct ora o;
+        if (!ioReadOra(io, &o)) return FALSE;
+        rec->hour = o.o;
+        rec->minute = o.m;
+        rec->second = o.s;
     }
-    fclose(f);
-    printf("File '%s' created: %zu byte, %lu record\n", filename, total_written, rec_no);
+    return ioEndRecord(io);
 }
 
-/* Tests reading performance using standard fscanf */
-void test_fscanf(const char *filename) {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        perror("fopen");
-        exit(1);
+/* Skips one field without converting it: whitespace, then the characters
+   the reader of that kind would consume ('d' decimal with optional sign,
+   'x' hex, 'f' floating point, 's' token). The token stops where
+   ioReadToken into Record.token stops, after at most 63 characters, so a
+   projection accepts exactly the records the full read accepts */
+static BOOL ioSkipField(MyIO *io, char kind) {
+    io->ptr = (char*)ffs_skip_space(io->ptr, io->end);
+    const char *p = io->ptr;
+    const char *q;
+    switch (kind) {
+    case 'd':
+        if (p < io->end && (*p == '+' || *p == '-')) p++;
+        q = ffs_skip_digits(p, io->end);
+        break;
+    case 'x':
+        if (io->end - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && ffs_hex_value(p[2]) >= 0)
+            p += 2;
+        q = ffs_skip_hex(p, io->end);
+        break;
+    case 'f':
+        q = ffs_skip_float(p, io->end);
+        if (!q) return FALSE;
+        io->ptr = (char*)q;
+        return TRUE;
+    default: {
+        size_t maxLen = sizeof(((Record*)0)->token);
+        const char *stop = ((size_t)(io->end - p) > maxLen - 1) ? p + (maxLen - 1) : io->end;
+        q = ffs_find_space(p, stop);
+        break;
     }
-    Record rec;
-    unsigned long count = 0;
-    clock_t start = clock();
-    while (fscanf(f, ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s %hd/%hd/%hd %hd:%hd:%hd\n",
-           &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
-           &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
-           &rec.field_float, &rec.field_ldouble, rec.token,
-           &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second) == 16)
-    {
-        count++;
     }
-    clock_t end = clock();
-    fclose(f);
-    double elapsed = (double)(end - start) / CLOCKS_PER_SEC;
-    printf("fscanf: %lu record read in %.3f seconds (%.3f usec/record)\n",
-           count, elapsed, (elapsed*1e6)/count);
+    if (q == p) return FALSE;
+    io->ptr = (char*)q;
+    return TRUE;
 }
 
-/* Tests reading performance using custom memory buffer parsing */
-void test_custom(const char *filename) {
-    MyIO io;
-    if (!ioOpen(&io, filename, TRUE)) {
-        fprintf(stderr, "ioOpen filed for %s\n", filename);
-        exit(1);
+/* Reads a record like read_record_custom, but converts only the fields
+   selected in 'fields' (REC_* bits); the others are skipped with a
+   character scan and left untouched in rec */
+BOOL read_record_projected(MyIO *io, Record *rec, unsigned fields) {
+    char c;
+    if (!ioReadChar(io, &c) || c != ':') return FALSE;
+    if (!((fields & REC_PN_PROG) ? ioReadHexULong(io, &rec->pn_prog) : ioSkipField(io, 'x'))) return FALSE;
+    if (!ioReadChar(io, &c) || c != '[') return FALSE;
+    if (!((fields & REC_PN_N) ? ioReadShort(io, &rec->pn_n) : ioSkipField(io, 'd'))) return FALSE;
+    if (!ioReadChar(io, &c) || c != ']') return FALSE;
+    if (!ioReadChar(io, &c) || c != '(') return FALSE;
+    if (!((fields & REC_FIELD_SHORT) ? ioReadShort(io, &rec->field_short) : ioSkipField(io, 'd'))) return FALSE;
+    if (!((fields & REC_FIELD_USHORT) ? ioReadUShort(io, &rec->field_ushort) : ioSkipField(io, 'd'))) return FALSE;
+    if (!((fields & REC_FIELD_INT) ? ioReadInt(io, &rec->field_int) : ioSkipField(io, 'd'))) return FALSE;
+    if (!((fields & REC_FIELD_HEXUSHORT) ? ioReadHexUShort(io, &rec->field_hexushort) : ioSkipField(io, 'x'))) return FALSE;
+    if (!((fields & REC_FIELD_HEXULONG) ? ioReadHexULong(io, &rec->field_hexulong) : ioSkipField(io, 'x'))) return FALSE;
+    if (!((fields & REC_FIELD_FLOAT) ? ioReadFloat(io, &rec->field_float) : ioSkipField(io, 'f'))) return FALSE;
+    if (!((fields & REC_FIELD_LDOUBLE) ? ioReadLongDouble(io, &rec->field_ldouble) : ioSkipField(io, 'f'))) return FALSE;
+    if (!((fields & REC_TOKEN) ? ioReadToken(io, rec->token, sizeof(rec->token)) : ioSkipField(io, 's'))) return FALSE;
+    if (!((fields & REC_DAY) ? ioReadShort(io, &rec->day) : ioSkipField(io, 'd'))) return FALSE;
+    if (!ioReadChar(io, &c) || c != '/') return FALSE;
+    if (!((fields & REC_MONTH) ? ioReadShort(io, &rec->month) : ioSkipField(io, 'd'))) return FALSE;
+    if (!ioReadChar(io, &c) || c != '/') return FALSE;
+    if (!((fields & REC_YEAR) ? ioReadShort(io, &rec->year) : ioSkipField(io, 'd'))) return FALSE;
+    if (!((fields & REC_HOUR) ? ioReadShort(io, &rec->hour) : ioSkipField(io, 'd'))) return FALSE;
+    if (!ioReadChar(io, &c) || c != ':') return FALSE;
+    if (!((fields & REC_MINUTE) ? ioReadShort(io, &rec->minute) : ioSkipField(io, 'd'))) return FALSE;
+    if (!ioReadChar(io, &c) || c != ':') return FALSE;
+    if (!((fields & REC_SECOND) ? ioReadShort(io, &rec->second) : ioSkipField(io, 'd'))) return FALSE;
+    return ioEndRecord(io);
+}
+
+/* Per-chunk output of read_records_parallel */
+typedef struct {
+    Record *recs;
+    size_t count, cap;
+} RecordChunk;
+
+typedef struct {
+    BOOL cpp;
+    RecordChunk *chunks;   /* NULL when only counting */
+} ParallelRecords;
+
+/* Appends a record to a chunk; FALSE when out of memory */
+static BOOL chunkPush(RecordChunk *c, const Record *rec) {
+    if (c->count == c->cap) {
+        size_t cap = c->cap ? c->cap * 2 : 1024;
+        Record *r = (Record*)realloc(c->recs, cap * sizeof(Record));
+        if (!r) return FALSE;
+        c->recs = r;
+        c->cap = cap;
     }
+    c->recs[c->count++] = *rec;
+    return TRUE;
+}
+
+/* FfsRangeFn: parses one newline-aligned range on its own thread */
+static unsigned long parseRecordRange(const char *buffer, size_t size, int chunk, void *ctx) {
+    ParallelRecords *pr = (ParallelRecords*)ctx;
+    RecordChunk *out = pr->chunks ? &pr->chunks[chunk] : NULL;
     Record rec;
     unsigned long count = 0;
-    clock_t start = clock();
-    while (read_record_custom(&io, &rec)) {
-        count++;
+    if (pr->cpp) {
+        size_t offset = 0;
+        while (fast_scan_record(buffer, size, &offset, &rec) == 16) {
+            if (out && !chunkPush(out, &rec)) break;
+            count++;
+        }
     }
-    clock_t end = clock();
-    double elapsed = (double)(end - start) / CLOCKS_PER_SEC;
-    printf("fscanfasta[C]: %lu record read in %.3f seconds (%.3f usec/record)\n",
-           count, elapsed, (elapsed*1e6)/count);
-    ioClose(&io);
+    else {
+        MyIO io;
+        memset(&io, 0, sizeof(io));
+        io.buffer = io.ptr = (char*)buffer;
+        io.end = io.buffer + size;
+        io.size = size;
+        while (read_record_custom(&io, &rec)) {
+            if (out && !chunkPush(out, &rec)) break;
+            count++;
+        }
+    }
+    return count;
 }
 
-void test_fast_fscanf_mem(const char *filename)
-{
-    // 1) Load file into memory
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
-        perror("fopen");
-        exit(1);
+/* Parses all records of buffer in parallel (see fscanfasta.h); the chunks
+   are newline-aligned by ffs_parse_parallel and merged here in file order */
+unsigned long read_records_parallel(const char *buffer, size_t size, int threads,
+                                    BOOL cpp, Record **out) {
+    ParallelRecords pr;
+    if (threads < 1) threads = 1;
+    pr.cpp = cpp;
+    pr.chunks = NULL;
+    if (out) {
+        *out = NULL;
+        pr.chunks = (RecordChunk*)calloc((size_t)threads, sizeof(RecordChunk));
+        if (!pr.chunks) return 0;
     }
-    fseek(fp, 0, SEEK_END);
-    long fsize = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
+    unsigned long count = ffs_parse_parallel(buffer, size, threads, parseRecordRange, &pr);
+    if (out) {
+        Record *all = (Record*)malloc((count ? count : 1) * sizeof(Record));
+        size_t pos = 0;
+        for (int i = 0; i < threads; ++i) {
+            if (all && pr.chunks[i].count) {
+                memcpy(all + pos, pr.chunks[i].recs, pr.chunks[i].count * sizeof(Record));
+                pos += pr.chunks[i].count;
+            }
+            free(pr.chunks[i].recs);
+        }
+        free(pr.chunks);
+        *out = all;
+        if (!all) return 0;
+    }
+    return count;
+}
 
-    char *buffer = (char*)malloc(fsize);
-    if (!buffer) {
-        fclose(fp);
-        fprintf(stderr, "malloc failed\n");
-        exit(1);
+/* ============== Test functions ============== */
+
+/* With -DFSCANFASTA_NO_MAIN this file builds as the I/O and record library
+   only, for programs with their own main (microbench.cpp) */
+#ifndef FSCANFASTA_NO_MAIN
+
+/* ============== Test data generator ============== */
+
+/* splitmix64 of (seed, record number): the field values of a seeded file */
+static unsigned long long seededValue(unsigned long long seed, unsigned long rec_no) {
+    unsigned long long z = seed + (rec_no + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* The formatters below write exactly what printf writes for the same
+   conversion, without parsing a format: "%llu", "%x", "%0*u" */
+static char *fmtUnsigned(char *p, unsigned long long v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+static char *fmtSigned(char *p, long long v) {
+    if (v < 0) {
+        *p++ = '-';
+        return fmtUnsigned(p, 0ULL - (unsigned long long)v);
     }
-    fread(buffer, 1, fsize, fp);
-    fclose(fp);
+    return fmtUnsigned(p, (unsigned long long)v);
+}
 
-    // 2) Prepare to parse
-    size_t offset = 0;
-    unsigned long count = 0;
+static char *fmtHex(char *p, unsigned long long v) {
+    char tmp[16];
+    int n = 0;
+    do {
+        tmp[n++] = "0123456789abcdef"[v & 15];
+        v >>= 4;
+    } while (v);
+    while (n) *p++ = tmp[--n];
+    return p;
+}
 
-    clock_t start = clock();
+/* v on at least 'width' digits, zero-padded */
+static char *fmtZeroPadded(char *p, unsigned v, int width) {
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n < width) tmp[n++] = '0';
+    while (n) *p++ = tmp[--n];
+    return p;
+}
 
-    Record rec;
-    // We'll parse lines with the same format you used in your old code:
-    // ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s %hd/%hd/%hd %hd:%hd:%hd\n"
-    //  This is 16 fields total.
-    while (1) {
-        int n = fast_fscanf_mem(buffer, fsize, &offset,
-            ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s "
-            "%hd/%hd/%hd %hd:%hd:%hd\n",
-            &rec.pn_prog, &rec.pn_n,
-            &rec.field_short, &rec.field_ushort,
-            &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
-            &rec.field_float, &rec.field_ldouble,
-            rec.token,
-            &rec.day, &rec.month, &rec.year,
-            &rec.hour, &rec.minute, &rec.second
-        );
-        if (n < 16) {
-            // not enough fields matched -> we're done
-            break;
+/* "%f" of m * 2^e (m < 2^53, m * 10^6 < 2^64 or e >= 0): the exact value
+   rounded to 6 decimals, ties to even like printf. Returns NULL when it does
+   not fit, for the caller to fall back to snprintf */
+static char *fmtFixed6(char *p, unsigned long long m, int e) {
+    unsigned long long q;
+    if (e >= 0) {
+        if (e > 63 - 53 || (m << e) > ~0ULL / 1000000) return NULL;
+        q = (m << e) * 1000000;
+    }
+    else {
+        int k = -e;
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 scaled = (unsigned __int128)m * 1000000;
+        if (k >= 128) q = 0;
+        else {
+            unsigned __int128 whole = scaled >> k;
+            unsigned __int128 rem = scaled - (whole << k);
+            unsigned __int128 half = (unsigned __int128)1 << (k - 1);
+            if (whole > ~0ULL - 1) return NULL;
+            q = (unsigned long long)whole;
+            if (rem > half || (rem == half && (q & 1))) q++;
         }
-        count++;
+#else
+        if (m > ~0ULL / 1000000) return NULL;
+        unsigned long long scaled = m * 1000000;
+        if (k >= 64) q = 0;
+        else {
+            unsigned long long rem = scaled & ((1ULL << k) - 1), half = 1ULL << (k - 1);
+            q = scaled >> k;
+            if (rem > half || (rem == half && (q & 1))) q++;
+        }
+#endif
     }
+    p = fmtUnsigned(p, q / 1000000);
+    *p++ = '.';
+    return fmtZeroPadded(p, (unsigned)(q % 1000000), 6);
+}
 
-    clock_t end = clock();
-    double elapsed = (double)(end - start) / CLOCKS_PER_SEC;
-    printf("fscanfasta[C++]: %lu record read in %.3f seconds (%.3f usec/record)\n",
-           count, elapsed, (elapsed*1e6)/count);
+/* printf("%f", f) for a finite f >= 0 */
+static char *fmtFloat(char *p, float f) {
+    unsigned int bits;
+    memcpy(&bits, &f, sizeof(bits));
+    int exp = (int)(bits >> 23) & 0xff;
+    unsigned long long m = bits & 0x7fffff;
+    char *q = NULL;
+    if (exp != 0xff && !(bits >> 31))
+        q = fmtFixed6(p, exp ? (m | 0x800000) : m, exp ? exp - 150 : -149);
+    return q ? q : p + sprintf(p, "%f", f);
+}
 
-    free(buffer);
+/* printf("%Lf", (long double)d) for a finite d >= 0 */
+static char *fmtDouble(char *p, double d) {
+    unsigned long long bits;
+    memcpy(&bits, &d, sizeof(bits));
+    int exp = (int)(bits >> 52) & 0x7ff;
+    unsigned long long m = bits & 0xfffffffffffffULL;
+    char *q = NULL;
+    if (exp != 0x7ff && !(bits >> 63))
+        q = fmtFixed6(p, exp ? (m | (1ULL << 52)) : m, exp ? exp - 1075 : -1074);
+    return q ? q : p + sprintf(p, "%Lf", (long double)d);
 }
 
-/* Main function - creates test file if needed, then runs benchmarks */
-int main(int argc, char *argv[]) {
-    const char *filename = "testdata.txt";
-    size_t target_size = 300UL * 1024 * 1024; // 300 MB
+/* Longest record the generator can write (fallbacks included); a record
+   with field values below 2^64 is under 200 bytes */
+#define GEN_RECORD_MAX 512
 
-    FILE *fcheck = fopen(filename, "r");
-    if (!fcheck) {
-        printf("Generating test file '%s' (~%zu byte)...\n", filename, target_size);
-        create_test_file(filename, target_size);
-    } else {
-        fclose(fcheck);
-        printf("Test file '%s' already existing.\n", filename);
-    }
+/* One record, as create_test_file has always written it with
+   ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %s %02hd/%02hd/%04hd %02hd:%02hd:%02hd\n" */
+static char *formatRecord(char *p, unsigned long rec_no, unsigned long long seed) {
+    unsigned long v = seed ? (unsigned long)(seededValue(seed, rec_no) % 10000000) : rec_no;
+    *p++ = ':';
+    p = fmtHex(p, rec_no);
+    memcpy(p, "[5]( ", 5);
+    p += 5;
+    p = fmtSigned(p, (short)(v % 32767));
+    *p++ = ' ';
+    p = fmtUnsigned(p, (unsigned short)(v % 65535));
+    *p++ = ' ';
+    p = fmtSigned(p, (int)v);
+    *p++ = ' ';
+    p = fmtHex(p, (unsigned short)(v % 65535));
+    *p++ = ' ';
+    p = fmtHex(p, v);
+    *p++ = ' ';
+    p = fmtFloat(p, (float)(v * 0.1));
+    *p++ = ' ';
+    p = fmtDouble(p, v * 0.01);
+    memcpy(p, " token 01/01/2020 ", 18);
+    p += 18;
+    p = fmtZeroPadded(p, (unsigned)(v % 24), 2);
+    *p++ = ':';
+    p = fmtZeroPadded(p, (unsigned)(v % 60), 2);
+    *p++ = ':';
+    p = fmtZeroPadded(p, (unsigned)(v % 60), 2);
+    *p++ = '\n';
+    return p;
+}
 
-    test_fscanf(filename);     // standard fscanf
-    test_custom(filename);     // your custom memory-based read
-    test_fast_fscanf_mem(filename); // newly-added fast_fscanf_mem test
+/* Records per block: the unit a generator thread formats */
+#define GEN_BLOCK_RECORDS 32768
+
+typedef struct {
+    unsigned long long seed;
+    unsigned long firstBlock;   /* block of task 0 in this round */
+    char **buf;                 /* one GEN_BLOCK_RECORDS * GEN_RECORD_MAX buffer per task */
+    size_t *len;
+} GenRound;
+
+/* FfsTaskFn: formats block firstBlock + task into its task's buffer */
+static void formatBlock(int task, void *ctx) {
+    GenRound *g = (GenRound*)ctx;
+    unsigned long rec_no = (g->firstBlock + (unsigned long)task) * GEN_BLOCK_RECORDS;
+    char *p = g->buf[task];
+    for (int i = 0; i < GEN_BLOCK_RECORDS; ++i)
+        p = formatRecord(p, rec_no + i, g->seed);
+    g->len[task] = (size_t)(p - g->buf[task]);
+}
+
+/* Creates test file with structured data of target_size bytes: records are
+   written until the total reaches target_size, the last one included.
+   The records are formatted in blocks, 'threads' blocks at a time in
+   parallel, and written in order, one large fwrite per block; the content
+   depends only on the size and the seed, not on the thread count.
+   With seed 0 every field is derived from the record number; any other
+   seed draws the field values from it (below 10^7, like the record
+   numbers of a few GB), pn_prog stays the record number. Progress goes
+   to stderr */
+void create_test_file(const char *filename, size_t target_size, unsigned long long seed, int threads) {
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        perror("fopen");
+        exit(1);
+    }
+    setvbuf(f, NULL, _IONBF, 0);    /* the blocks go straight to write() */
+    if (threads < 1) threads = 1;
+
+    GenRound g;
+    g.seed = seed;
+    g.buf = (char**)calloc((size_t)threads, sizeof(char*));
+    g.len = (size_t*)calloc((size_t)threads, sizeof(size_t));
+    for (int t = 0; g.buf && t < threads; ++t) {
+        g.buf[t] = (char*)malloc((size_t)GEN_BLOCK_RECORDS * GEN_RECORD_MAX);
+        if (!g.buf[t]) {
+            if (t == 0) break;
+            threads = t;    /* fewer, but at least one */
+        }
+    }
+    if (!g.buf || !g.len || !g.buf[0]) {
+        fprintf(stderr, "malloc failed\n");
+        exit(1);
+    }
+
+    size_t total_written = 0;
+    unsigned long rec_no = 0;
+    for (g.firstBlock = 0; total_written < target_size; g.firstBlock += (unsigned long)threads) {
+        ffs_run_parallel(threads, formatBlock, &g);
+        for (int t = 0; t < threads && total_written < target_size; ++t) {
+            const char *block = g.buf[t];
+            size_t len = g.len[t];
+            unsigned long records = GEN_BLOCK_RECORDS;
+            if (total_written + len >= target_size) {
+                /* stop after the record that reaches target_size */
+                const char *p = block;
+                records = 0;
+                do {
+                    p = (const char*)memchr(p, '\n', (size_t)(block + len - p)) + 1;
+                    records++;
+                } while (total_written + (size_t)(p - block) < target_size);
+                len = (size_t)(p - block);
+            }
+            if (fwrite(block, 1, len, f) != len) {
+                perror("fwrite");
+                exit(1);
+            }
+            total_written += len;
+            rec_no += records;
+        }
+        fprintf(stderr, "%lu record created, %zu bytes written...\n", rec_no, total_written);
+    }
+    fclose(f);
+    for (int t = 0; t < threads; ++t) free(g.buf[t]);
+    free(g.buf);
+    free(g.len);
+    fprintf(stderr, "File '%s' created: %zu byte, %lu record\n", filename, total_written, rec_no);
+}
+
+/* ============== The parse methods, through the benchmark harness ============== */
+
+/* Loads a whole file into a malloc'd buffer for the C++ parser tests,
+   followed by IO_PADDING zero bytes like loadFileIntoBuffer */
+static char *loadWholeFile(const char *filename, size_t *size)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        perror("fopen");
+        exit(1);
+    }
+    fseek(fp, 0, SEEK_END);
+    long fsize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char *buffer = (char*)malloc(fsize + IO_PADDING);
+    if (!buffer) {
+        fclose(fp);
+        fprintf(stderr, "malloc failed\n");
+        exit(1);
+    }
+    fread(buffer, 1, fsize, fp);
+    memset(buffer + fsize, 0, IO_PADDING);
+    fclose(fp);
+    *size = (size_t)fsize;
+    return buffer;
+}
+
+/* Size of a file without reading it */
+static size_t fileSizeOf(const char *filename)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        perror("fopen");
+        exit(1);
+    }
+    fseek(fp, 0, SEEK_END);
+    long fsize = ftell(fp);
+    fclose(fp);
+    return (size_t)fsize;
+}
+
+#define RECORD_FORMAT ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s " \
+                      "%hd/%hd/%hd %hd:%hd:%hd\n"
+
+/* Shared input of the method workloads: the file is loaded and the format
+   compiled once, outside the timed runs (fscanf reads the file itself).
+   With a cold cache the file is dropped from the page cache before every
+   run, and the runs read it themselves */
+typedef struct {
+    const char *filename;
+    char *buffer;       /* NULL when cold */
+    size_t size;
+    FfsPlan *plan;
+    BOOL cold;
+    int threads;        /* for the parallel methods */
+} MethodInput;
+
+/* Asks the OS to drop the cached pages of a file, so that the next read
+   comes from the disk. Returns FALSE where that is not possible */
+static BOOL dropFileCache(const char *filename) {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return FALSE;
+    fsync(fd);      /* dirty pages cannot be dropped */
+    int rc = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    return rc == 0;
+#else
+    (void)filename;
+    return FALSE;
+#endif
+}
+
+/* BenchConfig.setup of the cold-cache runs */
+static void evictInput(void *ctx) {
+    dropFileCache(((const MethodInput*)ctx)->filename);
+}
+
+/* The buffer a run parses: the preloaded one, or the file read by the run
+   itself when cold (then also returned in *owned, for the run to free) */
+static char *methodBuffer(const MethodInput *in, size_t *size, char **owned) {
+    *owned = NULL;
+    if (!in->cold) {
+        *size = in->size;
+        return in->buffer;
+    }
+    *owned = loadWholeFile(in->filename, size);
+    return *owned;
+}
+
+/* Standard fscanf, file opened by every run */
+static unsigned long runFscanf(void *ctx) {
+    const MethodInput *in = (const MethodInput*)ctx;
+    FILE *f = fopen(in->filename, "r");
+    if (!f) {
+        perror("fopen");
+        exit(1);
+    }
+    Record rec;
+    unsigned long count = 0;
+    while (fscanf(f, RECORD_FORMAT,
+           &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
+           &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+           &rec.field_float, &rec.field_ldouble, rec.token,
+           &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second) == 16)
+    {
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/* Custom memory buffer parsing: read_record_custom over the loaded buffer */
+static unsigned long runCustom(void *ctx) {
+    char *owned;
+    size_t size;
+    char *buffer = methodBuffer((const MethodInput*)ctx, &size, &owned);
+    MyIO io;
+    memset(&io, 0, sizeof(io));
+    io.buffer = io.ptr = buffer;
+    io.end = buffer + size;
+    io.size = size;
+    Record rec;
+    unsigned long count = 0;
+    while (read_record_custom(&io, &rec)) {
+        count++;
+    }
+    free(owned);
+    return count;
+}
+
+/* fast_fscanf_mem, format interpreted on every call */
+static unsigned long runFastMem(void *ctx) {
+    char *owned;
+    size_t size;
+    const char *buffer = methodBuffer((const MethodInput*)ctx, &size, &owned);
+    size_t offset = 0;
+    unsigned long count = 0;
+    Record rec;
+    while (fast_fscanf_mem(buffer, size, &offset, RECORD_FORMAT,
+            &rec.pn_prog, &rec.pn_n,
+            &rec.field_short, &rec.field_ushort,
+            &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+            &rec.field_float, &rec.field_ldouble,
+            rec.token,
+            &rec.day, &rec.month, &rec.year,
+            &rec.hour, &rec.minute, &rec.second) == 16)
+    {
+        count++;
+    }
+    free(owned);
+    return count;
+}
+
+/* Same as runFastMem, but the format is compiled once up front */
+static unsigned long runPlan(void *ctx) {
+    const MethodInput *in = (const MethodInput*)ctx;
+    char *owned;
+    size_t size;
+    const char *buffer = methodBuffer(in, &size, &owned);
+    size_t offset = 0;
+    unsigned long count = 0;
+    Record rec;
+    while (ffs_scan_plan(in->plan, buffer, size, &offset,
+            &rec.pn_prog, &rec.pn_n,
+            &rec.field_short, &rec.field_ushort,
+            &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+            &rec.field_float, &rec.field_ldouble,
+            rec.token,
+            &rec.day, &rec.month, &rec.year,
+            &rec.hour, &rec.minute, &rec.second) == 16)
+    {
+        count++;
+    }
+    free(owned);
+    return count;
+}
+
+/* Same records, parsed by the compile-time specialised fscanfasta::scan front-end */
+static unsigned long runTmpl(void *ctx) {
+    char *owned;
+    size_t size;
+    const char *buffer = methodBuffer((const MethodInput*)ctx, &size, &owned);
+    size_t offset = 0;
+    unsigned long count = 0;
+    Record rec;
+    while (fast_scan_record(buffer, size, &offset, &rec) == 16) {
+        count++;
+    }
+    free(owned);
+    return count;
+}
+
+/* read_records_parallel on in->threads threads, C and C++ tmpl records */
+static unsigned long runParallel(void *ctx) {
+    const MethodInput *in = (const MethodInput*)ctx;
+    char *owned;
+    size_t size;
+    const char *buffer = methodBuffer(in, &size, &owned);
+    unsigned long count = read_records_parallel(buffer, size, in->threads, FALSE, NULL);
+    free(owned);
+    return count;
+}
+
+static unsigned long runParallelTmpl(void *ctx) {
+    const MethodInput *in = (const MethodInput*)ctx;
+    char *owned;
+    size_t size;
+    const char *buffer = methodBuffer(in, &size, &owned);
+    unsigned long count = read_records_parallel(buffer, size, in->threads, TRUE, NULL);
+    free(owned);
+    return count;
+}
+
+/* The methods --methods can choose from, by key; 'threaded' ones spawn
+   their own threads and are not pinned (the threads would inherit the
+   affinity of the pinned one) */
+static const struct {
+    const char *key;
+    const char *name;
+    BenchFn fn;
+    BOOL threaded;
+} methodTable[] = {
+    { "fscanf",        "fscanf",               runFscanf,       FALSE },
+    { "custom",        "fscanfasta[C]",        runCustom,       FALSE },
+    { "mem",           "fscanfasta[C++]",      runFastMem,      FALSE },
+    { "plan",          "fscanfasta[C++ plan]", runPlan,         FALSE },
+    { "tmpl",          "fscanfasta[C++ tmpl]", runTmpl,         FALSE },
+    { "parallel",      "fscanfasta[C] xN",     runParallel,     TRUE },
+    { "parallel-tmpl", "fscanfasta[C++ tmpl] xN", runParallelTmpl, TRUE },
+};
+enum { METHOD_COUNT = sizeof(methodTable) / sizeof(methodTable[0]) };
+#define METHODS_DEFAULT 0x1fu    /* the 5 single-threaded methods */
+
+/* ============== Command line ============== */
+
+enum { OUTPUT_TEXT, OUTPUT_JSON, OUTPUT_CSV };
+
+/* Experiments after the methods (--tests) */
+enum {
+    TEST_LOAD = 1, TEST_STREAM = 2, TEST_PARALLEL = 4, TEST_INDEX = 8,
+    TEST_CACHE = 16, TEST_COLUMNS = 32, TEST_PROJECTION = 64,
+    TEST_PREDICATES = 128, TEST_VIEWS = 256, TEST_ALL = 511
+};
+static const char *const testKeys[] = {
+    "load", "stream", "parallel", "index", "cache", "columns", "projection",
+    "predicates", "views"
+};
+
+typedef struct {
+    const char *filename;
+    size_t size;                /* of the generated file */
+    unsigned long long seed;
+    BOOL generate;              /* even if the file exists */
+    unsigned methods;           /* bit i: methodTable[i] */
+    int threads;
+    int warmup, repetitions;
+    BOOL cold;
+    BOOL counters;
+    int output;                 /* OUTPUT_* */
+    const char *results;        /* file for the methods results, NULL: stdout */
+    int tests;                  /* TEST_* bits, -1: default */
+} Options;
+
+static void usage(const char *prog, FILE *out) {
+    fprintf(out,
+        "usage: %s [options] [file]\n"
+        "  file                    input, generated if missing (default testdata.txt)\n"
+        "  -s, --size N[K|M|G|T]   size of the generated file (default 300M)\n"
+        "      --seed N            generator seed; 0, the default, writes the original sequence\n"
+        "  -g, --generate          generate the file even if it exists\n"
+        "  -m, --methods LIST      comma-separated, or 'all': fscanf,custom,mem,plan,tmpl,\n"
+        "                          parallel,parallel-tmpl (default: the first five)\n"
+        "  -t, --threads N         threads of the parallel methods and tests (default: all)\n"
+        "  -r, --repetitions N     timed runs per method (default 5)\n"
+        "  -w, --warmup N          untimed runs before them (default 1)\n"
+        "      --cold | --warm     drop the file from the page cache before every run, and\n"
+        "                          read it inside the timed run; or keep it loaded (default)\n"
+        "      --no-counters       do not read the hardware counters\n"
+        "  -o, --output FORMAT     text, json or csv (default text)\n"
+        "  -O, --results PATH      write the methods results there instead of stdout\n"
+        "      --tests LIST        experiments after the methods, comma-separated, 'all' or\n"
+        "                          'none': load,stream,parallel,index,cache,columns,\n"
+        "                          projection,predicates,views (default: all with text\n"
+        "                          output, none with json and csv)\n"
+        "  -h, --help\n", prog);
+}
+
+/* "300M", "10MB", "50G", "4096": binary multiples */
+static BOOL parseSize(const char *s, size_t *out) {
+    char *end;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (!ffs_is_digit(*s) || end == s || errno) return FALSE;
+    int shift = 0;
+    switch (*end) {
+    case 'k': case 'K': shift = 10; end++; break;
+    case 'm': case 'M': shift = 20; end++; break;
+    case 'g': case 'G': shift = 30; end++; break;
+    case 't': case 'T': shift = 40; end++; break;
+    }
+    if (shift && (*end == 'b' || *end == 'B')) end++;
+    if (*end || v > ((unsigned long long)SIZE_MAX >> shift)) return FALSE;
+    *out = (size_t)(v << shift);
+    return TRUE;
+}
+
+static BOOL parseInt(const char *s, int min, int *out) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s || *end || v < min || v > INT_MAX) return FALSE;
+    *out = (int)v;
+    return TRUE;
+}
+
+/* Comma-separated keys of 'keys' to a bit mask; "all" sets every bit and
+   "none" none. Returns FALSE on an unknown key */
+static BOOL parseList(const char *s, const char *const *keys, size_t stride, int count, unsigned *out) {
+    unsigned mask = 0;
+    while (*s) {
+        size_t len = strcspn(s, ",");
+        int found = 0;
+        if (len == 3 && !strncmp(s, "all", 3)) {
+            mask = (1u << count) - 1;
+            found = 1;
+        }
+        else if (len == 4 && !strncmp(s, "none", 4))
+            found = 1;
+        for (int i = 0; i < count && !found; ++i) {
+            const char *key = *(const char *const *)((const char*)keys + i * stride);
+            if (strlen(key) == len && !strncmp(s, key, len)) {
+                mask |= 1u << i;
+                found = 1;
+            }
+        }
+        if (!found) return FALSE;
+        s += len;
+        if (*s == ',') s++;
+    }
+    *out = mask;
+    return TRUE;
+}
+
+/* Fills *opt from the command line; on an error prints it with the usage
+   and returns FALSE */
+static BOOL parseOptions(int argc, char *argv[], Options *opt) {
+    memset(opt, 0, sizeof(*opt));
+    opt->filename = "testdata.txt";
+    opt->size = 300UL * 1024 * 1024; // 300 MB
+    opt->methods = METHODS_DEFAULT;
+    opt->threads = ffs_hardware_threads();
+    opt->warmup = 1;
+    opt->repetitions = 5;
+    opt->counters = TRUE;
+    opt->output = OUTPUT_TEXT;
+    opt->tests = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        BOOL ok = TRUE, takesValue = TRUE;
+        unsigned mask;
+        if (!strcmp(a, "-h") || !strcmp(a, "--help")) {
+            usage(argv[0], stdout);
+            exit(0);
+        }
+        else if (!strcmp(a, "-g") || !strcmp(a, "--generate")) { opt->generate = TRUE; takesValue = FALSE; }
+        else if (!strcmp(a, "--cold")) { opt->cold = TRUE; takesValue = FALSE; }
+        else if (!strcmp(a, "--warm")) { opt->cold = FALSE; takesValue = FALSE; }
+        else if (!strcmp(a, "--no-counters")) { opt->counters = FALSE; takesValue = FALSE; }
+        else if (a[0] != '-') { opt->filename = a; takesValue = FALSE; }
+        else if (!v) ok = FALSE;
+        else if (!strcmp(a, "-s") || !strcmp(a, "--size")) ok = parseSize(v, &opt->size) && opt->size > 0;
+        else if (!strcmp(a, "--seed")) {
+            char *end;
+            errno = 0;
+            opt->seed = strtoull(v, &end, 0);
+            ok = (ffs_is_digit(*v) && end != v && !*end && !errno);  /* no sign: -1 would wrap */
+        }
+        else if (!strcmp(a, "-m") || !strcmp(a, "--methods")) {
+            ok = parseList(v, &methodTable[0].key, sizeof(methodTable[0]), METHOD_COUNT, &mask);
+            opt->methods = mask;
+        }
+        else if (!strcmp(a, "-t") || !strcmp(a, "--threads")) ok = parseInt(v, 1, &opt->threads);
+        else if (!strcmp(a, "-r") || !strcmp(a, "--repetitions")) ok = parseInt(v, 1, &opt->repetitions);
+        else if (!strcmp(a, "-w") || !strcmp(a, "--warmup")) ok = parseInt(v, 0, &opt->warmup);
+        else if (!strcmp(a, "-o") || !strcmp(a, "--output")) {
+            if (!strcmp(v, "text")) opt->output = OUTPUT_TEXT;
+            else if (!strcmp(v, "json")) opt->output = OUTPUT_JSON;
+            else if (!strcmp(v, "csv")) opt->output = OUTPUT_CSV;
+            else ok = FALSE;
+        }
+        else if (!strcmp(a, "-O") || !strcmp(a, "--results")) opt->results = v;
+        else if (!strcmp(a, "--tests")) {
+            ok = parseList(v, testKeys, sizeof(testKeys[0]), (int)(sizeof(testKeys) / sizeof(testKeys[0])), &mask);
+            opt->tests = (int)mask;
+        }
+        else {
+            fprintf(stderr, "unknown option %s\n", a);
+            usage(argv[0], stderr);
+            return FALSE;
+        }
+        if (!ok) {
+            fprintf(stderr, v ? "bad value for %s: %s\n" : "missing value for %s\n", a, v);
+            usage(argv[0], stderr);
+            return FALSE;
+        }
+        if (takesValue) i++;
+    }
+    if (opt->tests < 0)
+        opt->tests = (opt->output == OUTPUT_TEXT) ? TEST_ALL : 0;
+    return TRUE;
+}
+
+/* Runs the selected methods through bench_run (warmup, repeated runs,
+   pinned to one CPU unless threaded, hardware counters where available)
+   and writes the results in the chosen format to opt->results or stdout.
+   'info' receives the notes around the table */
+static void test_methods(const Options *opt, FILE *info)
+{
+    MethodInput in;
+    in.filename = opt->filename;
+    in.threads = opt->threads;
+    in.cold = opt->cold;
+    if (in.cold && !dropFileCache(opt->filename)) {
+        fprintf(stderr, "cannot drop %s from the page cache here, running warm\n", opt->filename);
+        in.cold = FALSE;
+    }
+    /* cold runs load the file themselves: reading it here would only cost
+       memory and bring it back into the page cache */
+    if (in.cold) {
+        in.buffer = NULL;
+        in.size = fileSizeOf(opt->filename);
+    }
+    else {
+        in.buffer = loadWholeFile(opt->filename, &in.size);
+    }
+    in.plan = ffs_compile(RECORD_FORMAT);
+    if (!in.plan) {
+        fprintf(stderr, "ffs_compile failed\n");
+        exit(1);
+    }
+
+    BenchResult results[METHOD_COUNT];
+    int count = 0;
+    int pinned = -1;
+    for (int i = 0; i < METHOD_COUNT; ++i) {
+        if (!(opt->methods & (1u << i))) continue;
+        BenchConfig cfg = BENCH_DEFAULT_CONFIG;
+        cfg.warmup = opt->warmup;
+        cfg.repetitions = opt->repetitions;
+        cfg.counters = opt->counters;
+        if (methodTable[i].threaded) cfg.cpu = BENCH_NO_PIN;
+        if (in.cold) cfg.setup = evictInput;
+        char name[64];
+        const char *x = strstr(methodTable[i].name, " xN");
+        if (x)
+            snprintf(name, sizeof(name), "%.*s x%d", (int)(x - methodTable[i].name),
+                     methodTable[i].name, opt->threads);
+        else
+            snprintf(name, sizeof(name), "%s", methodTable[i].name);
+        bench_run(&cfg, name, in.size, methodTable[i].fn, &in, &results[count]);
+        if (results[count].cpu >= 0) pinned = results[count].cpu;
+        count++;
+    }
+
+    fprintf(info, "%d warmup + %d timed runs each, %s cache, median wall time",
+            opt->warmup, opt->repetitions, in.cold ? "cold" : "warm");
+    if (pinned >= 0) fprintf(info, ", pinned to CPU %d", pinned);
+    fprintf(info, "\n");
+
+    FILE *out = stdout;
+    if (opt->results && !(out = fopen(opt->results, "w"))) {
+        perror(opt->results);
+        exit(1);
+    }
+    if (opt->output == OUTPUT_JSON)
+        bench_print_json(out, results, count);
+    else if (opt->output == OUTPUT_CSV)
+        bench_print_csv(out, results, count);
+    else {
+        bench_print_table(out, results, count);
+        if (opt->counters) bench_print_counters(out, results, count);
+    }
+    if (opt->results) {
+        fclose(out);
+        fprintf(info, "Results written to %s\n", opt->results);
+    }
+
+    ffs_free_plan(in.plan);
+    free(in.buffer);
+}
+
+/* Time-to-first-record and total wall time, open included, of one loader
+   (read into a buffer when mapFlags < 0, ioOpenMapped otherwise) feeding
+   either read_record_custom or the C++ fast_scan_record */
+static void test_load(const char *filename, const char *label, int mapFlags, BOOL cpp)
+{
+    MyIO io;
+    Record rec;
+    size_t offset = 0;
+    unsigned long count = 0;
+
+    double start = bench_wall_seconds();
+    BOOL ok = (mapFlags < 0) ? ioOpen(&io, filename, TRUE)
+                             : ioOpenMapped(&io, filename, (unsigned)mapFlags);
+    if (!ok) {
+        fprintf(stderr, "open failed for %s\n", filename);
+        exit(1);
+    }
+    double first = 0;
+    for (;;) {
+        BOOL got = cpp ? (fast_scan_record(io.buffer, io.size, &offset, &rec) == 16)
+                       : read_record_custom(&io, &rec);
+        if (!got) break;
+        if (count++ == 0) first = bench_wall_seconds() - start;
+    }
+    double total = bench_wall_seconds() - start;
+    ioClose(&io);
+
+    printf("%-28s first record after %8.3f ms, %lu record in %.3f seconds\n",
+           label, first * 1e3, count, total);
+}
+
+/* Streaming mode: read_record_custom and fast_fscanf_mem across chunk
+   boundaries, with memory bounded by two windows */
+static void test_stream(const char *filename, size_t window, BOOL cpp)
+{
+    MyIO io;
+    if (!ioOpenStream(&io, filename, window)) {
+        fprintf(stderr, "ioOpenStream failed for %s\n", filename);
+        exit(1);
+    }
+    Record rec;
+    unsigned long count = 0;
+    double start = bench_wall_seconds();
+    if (!cpp) {
+        while (read_record_custom(&io, &rec))
+            count++;
+    }
+    else {
+        do {
+            size_t offset = 0;
+            size_t avail = (size_t)(io.end - io.ptr);
+            while (fast_fscanf_mem(io.ptr, avail, &offset,
+                    ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s "
+                    "%hd/%hd/%hd %hd:%hd:%hd\n",
+                    &rec.pn_prog, &rec.pn_n,
+                    &rec.field_short, &rec.field_ushort,
+                    &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+                    &rec.field_float, &rec.field_ldouble,
+                    rec.token,
+                    &rec.day, &rec.month, &rec.year,
+                    &rec.hour, &rec.minute, &rec.second) == 16)
+            {
+                count++;
+            }
+            if (offset == 0 && avail > 0) {
+                fprintf(stderr, "malformed record in %s, stopping\n", filename);
+                break;
+            }
+            io.ptr += offset;
+        } while (ioRefill(&io));
+    }
+    double total = bench_wall_seconds() - start;
+    if (ioStreamError(&io))
+        fprintf(stderr, "%s: stream stopped before the end of the file\n", filename);
+    ioClose(&io);
+
+    printf("%-28s %lu record in %.3f seconds (%zu KB window)\n",
+           cpp ? "fscanfasta[C++] stream" : "fscanfasta[C] stream",
+           count, total, (window ? window : IO_STREAM_WINDOW) >> 10);
+}
+
+/* Scaling curve of read_records_parallel from 1 thread up to the number of
+   hardware threads, on a buffer already in memory (wall clock) */
+static void test_parallel(const char *filename, BOOL cpp, int maxThreads)
+{
+    size_t fsize;
+    char *buffer = loadWholeFile(filename, &fsize);
+    double base = 0;
+
+    printf("%-24s %7s %10s %10s %8s\n", cpp ? "fscanfasta[C++ tmpl]" : "fscanfasta[C]",
+           "threads", "seconds", "MB/s", "speedup");
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads;
+        double start = bench_wall_seconds();
+        unsigned long count = read_records_parallel(buffer, fsize, threads, cpp, NULL);
+        double elapsed = bench_wall_seconds() - start;
+        if (threads == 1) base = elapsed;
+        printf("%-24s %7d %10.3f %10.1f %7.2fx  (%lu record)\n", "", threads, elapsed,
+               (double)fsize / (1024.0 * 1024.0) / elapsed, base / elapsed, count);
+        if (threads == maxThreads) break;
+    }
+    free(buffer);
+}
+
+/* Random access through the sidecar index: parses 'count' records starting
+   at the middle of the file, with the range taken from testdata.txt.idx vs
+   a linear ioSkipLine scan up to it (wall clock, file mapped) */
+static void test_index_range(const char *filename, size_t count)
+{
+    double start = bench_wall_seconds();
+    if (!line_index_build(filename)) {
+        fprintf(stderr, "line_index_build failed for %s\n", filename);
+        exit(1);
+    }
+    double tBuild = bench_wall_seconds() - start;
+
+    start = bench_wall_seconds();
+    LineIndex *idx = line_index_open(filename, FALSE);
+    if (!idx) {
+        fprintf(stderr, "line_index_open failed for %s\n", filename);
+        exit(1);
+    }
+    double tOpen = bench_wall_seconds() - start;
+    size_t first = line_index_count(idx) / 2;
+
+    MyIO io;
+    if (!ioOpenMapped(&io, filename, 0)) {
+        fprintf(stderr, "ioOpenMapped failed for %s\n", filename);
+        exit(1);
+    }
+    Record rec;
+    unsigned long got = 0;
+    start = bench_wall_seconds();
+    size_t begin, end;
+    if (line_index_range(idx, first, count, &begin, &end)) {
+        size_t offset = begin;
+        while (fast_fscanf_mem(io.buffer, end, &offset,
+                ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s "
+                "%hd/%hd/%hd %hd:%hd:%hd\n",
+                &rec.pn_prog, &rec.pn_n,
+                &rec.field_short, &rec.field_ushort,
+                &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+                &rec.field_float, &rec.field_ldouble,
+                rec.token,
+                &rec.day, &rec.month, &rec.year,
+                &rec.hour, &rec.minute, &rec.second) == 16)
+        {
+            got++;
+        }
+    }
+    double tIndexed = bench_wall_seconds() - start;
+
+    unsigned long gotLinear = 0;
+    start = bench_wall_seconds();
+    io.ptr = io.buffer;
+    for (size_t i = 0; i < first && ioSkipLine(&io); ++i)
+        ;
+    while (gotLinear < count && read_record_custom(&io, &rec))
+        gotLinear++;
+    double tLinear = bench_wall_seconds() - start;
+
+    printf("index: built in %.3f s, loaded in %.3f ms (%zu lines)\n",
+           tBuild, tOpen * 1e3, line_index_count(idx));
+    printf("records %zu..%zu: %lu via index in %.3f ms, %lu via linear scan in %.3f ms\n",
+           first, first + count - 1, got, tIndexed * 1e3, gotLinear, tLinear * 1e3);
+    ioClose(&io);
+    line_index_close(idx);
+}
+
+/* Binary snapshot cache: first run parses the text and writes
+   testdata.txt.rcache, later runs map it instead (wall clock) */
+static void test_record_cache(const char *filename)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s.rcache", filename);
+    remove(path);
+
+    int threads = ffs_hardware_threads();
+    for (int run = 0; run < 2; ++run) {
+        double start = bench_wall_seconds();
+        RecordSnapshot *snap = record_cache_load(filename, threads);
+        if (!snap) {
+            fprintf(stderr, "record_cache_load failed for %s\n", filename);
+            exit(1);
+        }
+        size_t count;
+        const Record *recs = record_snapshot_records(snap, &count);
+        unsigned long sum = 0;
+        for (size_t i = 0; i < count; ++i)    /* touch every record */
+            sum += recs[i].pn_prog;
+        double elapsed = bench_wall_seconds() - start;
+        printf("%-28s %zu record in %.3f seconds (checksum %lu)\n",
+               run == 0 ? "rcache miss (parse + write)" : "rcache hit (hash + mmap)",
+               count, elapsed, sum);
+        record_snapshot_close(snap);
+    }
+}
+
+/* Sum of field_int over an AoS Record array vs the field_int column,
+   repeated so the aggregation time is measurable */
+#define AGG_REPEAT 20
+
+/* Record array (AoS) vs columnar batches (SoA): decode time, then the time to
+   aggregate one column (wall clock, single thread) */
+static void test_columns(const char *filename)
+{
+    size_t fsize;
+    char *buffer = loadWholeFile(filename, &fsize);
+    long long sum;
+
+    /* AoS */
+    double start = bench_wall_seconds();
+    Record *recs = NULL;
+    unsigned long count = read_records_parallel(buffer, fsize, 1, TRUE, &recs);
+    double tParse = bench_wall_seconds() - start;
+    start = bench_wall_seconds();
+    sum = 0;
+    for (int r = 0; r < AGG_REPEAT; ++r)
+        for (unsigned long i = 0; i < count; ++i)
+            sum += recs[i].field_int;
+    double tAgg = (bench_wall_seconds() - start) / AGG_REPEAT;
+    printf("%-26s %lu record, decode %.3f s, sum(field_int) %.2f ms (%lld)\n",
+           "Record[] (AoS)", count, tParse, tAgg * 1e3, sum / AGG_REPEAT);
+    free(recs);
+
+    /* SoA, whole file in one batch */
+    RecordColumns cols;
+    if (!record_columns_init(&cols, 0)) {
+        fprintf(stderr, "record_columns_init failed\n");
+        exit(1);
+    }
+    size_t offset = 0;
+    start = bench_wall_seconds();
+    size_t rows = read_record_columns(buffer, fsize, &offset, &cols);
+    tParse = bench_wall_seconds() - start;
+    start = bench_wall_seconds();
+    sum = 0;
+    for (int r = 0; r < AGG_REPEAT; ++r)
+        for (size_t i = 0; i < rows; ++i)
+            sum += cols.field_int[i];
+    tAgg = (bench_wall_seconds() - start) / AGG_REPEAT;
+    printf("%-26s %zu record, decode %.3f s, sum(field_int) %.2f ms (%lld)\n",
+           "columns (SoA)", rows, tParse, tAgg * 1e3, sum / AGG_REPEAT);
+    record_columns_free(&cols);
+
+    /* SoA in row groups, aggregated batch by batch */
+    if (!record_columns_init(&cols, 65536)) {
+        fprintf(stderr, "record_columns_init failed\n");
+        exit(1);
+    }
+    offset = 0;
+    rows = 0;
+    sum = 0;
+    start = bench_wall_seconds();
+    while (read_record_columns(buffer, fsize, &offset, &cols) > 0) {
+        for (size_t i = 0; i < cols.count; ++i)
+            sum += cols.field_int[i];
+        rows += cols.count;
+    }
+    tParse = bench_wall_seconds() - start;
+    printf("%-26s %zu record, decode + sum %.3f s (%lld)\n",
+           "columns, 64K row groups", rows, tParse, sum);
+    record_columns_free(&cols);
+
+    free(buffer);
+}
+
+/* One record of test_projection with fast_fscanf_mem, or with plan when it
+   is not NULL; 'want' conversions is 16 for the full format, else 1 or 4 */
+static BOOL scanProjected(const char *buffer, size_t size, const char *format,
+                          FfsPlan *plan, int want, Record *rec)
+{
+    size_t offset = 0;
+    int n;
+    if (want == 16 && plan)
+        n = ffs_scan_plan(plan, buffer, size, &offset,
+                &rec->pn_prog, &rec->pn_n, &rec->field_short, &rec->field_ushort,
+                &rec->field_int, &rec->field_hexushort, &rec->field_hexulong,
+                &rec->field_float, &rec->field_ldouble, rec->token,
+                &rec->day, &rec->month, &rec->year, &rec->hour, &rec->minute, &rec->second);
+    else if (want == 16)
+        n = fast_fscanf_mem(buffer, size, &offset, format,
+                &rec->pn_prog, &rec->pn_n, &rec->field_short, &rec->field_ushort,
+                &rec->field_int, &rec->field_hexushort, &rec->field_hexulong,
+                &rec->field_float, &rec->field_ldouble, rec->token,
+                &rec->day, &rec->month, &rec->year, &rec->hour, &rec->minute, &rec->second);
+    else if (plan)
+        n = ffs_scan_plan(plan, buffer, size, &offset,
+                &rec->pn_prog, &rec->field_int, &rec->year, &rec->hour);
+    else
+        n = fast_fscanf_mem(buffer, size, &offset, format,
+                &rec->pn_prog, &rec->field_int, &rec->year, &rec->hour);
+    return n == want && offset == size;
+}
+
+/* Projection pushdown: throughput when only 1, 4 or all 16 fields are
+   converted, the others skipped (REC_* mask for the C reader, %* in the
+   format for fast_fscanf_mem and the plans) */
+static void test_projection(const char *filename)
+{
+    static const struct {
+        const char *label;
+        unsigned fields;
+        const char *format;
+    } proj[] = {
+        { "1 field (pn_prog)", REC_PN_PROG,
+          ":%lx[%*hd]( %*hd %*hu %*d %*hx %*lx %*f %*Lf %*63s %*hd/%*hd/%*hd %*hd:%*hd:%*hd\n" },
+        { "4 fields (+int,year,hour)", REC_PN_PROG | REC_FIELD_INT | REC_YEAR | REC_HOUR,
+          ":%lx[%*hd]( %*hd %*hu %d %*hx %*lx %*f %*Lf %*63s %*hd/%*hd/%hd %hd:%*hd:%*hd\n" },
+        { "16 fields", REC_ALL_FIELDS,
+          ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s %hd/%hd/%hd %hd:%hd:%hd\n" },
+    };
+    size_t fsize;
+    char *buffer = loadWholeFile(filename, &fsize);
+    double mb = (double)fsize / (1024.0 * 1024.0);
+    Record rec;
+    memset(&rec, 0, sizeof(rec));
+
+    printf("%-26s %14s %14s %14s\n", "projection", "C (MB/s)", "C++ (MB/s)", "plan (MB/s)");
+    for (size_t k = 0; k < sizeof(proj) / sizeof(proj[0]); ++k) {
+        unsigned long count = 0;
+        MyIO io;
+        memset(&io, 0, sizeof(io));
+        io.buffer = io.ptr = buffer;
+        io.end = buffer + fsize;
+        double start = bench_wall_seconds();
+        while (read_record_projected(&io, &rec, proj[k].fields))
+            count++;
+        double tC = bench_wall_seconds() - start;
+
+        /* the projected formats fill pn_prog [, field_int, year, hour]; the
+           full one takes all 16 arguments, extra ones are ignored */
+        size_t offset = 0;
+        int want = (proj[k].fields == REC_ALL_FIELDS) ? 16 : (proj[k].fields == REC_PN_PROG) ? 1 : 4;
+        start = bench_wall_seconds();
+        if (want == 16) {
+            while (fast_fscanf_mem(buffer, fsize, &offset, proj[k].format,
+                    &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
+                    &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+                    &rec.field_float, &rec.field_ldouble, rec.token,
+                    &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second) == want)
+                ;
+        } else {
+            while (fast_fscanf_mem(buffer, fsize, &offset, proj[k].format,
+                    &rec.pn_prog, &rec.field_int, &rec.year, &rec.hour) == want)
+                ;
+        }
+        double tCpp = bench_wall_seconds() - start;
+
+        FfsPlan *plan = ffs_compile(proj[k].format);
+        if (!plan) {
+            fprintf(stderr, "ffs_compile failed\n");
+            exit(1);
+        }
+        offset = 0;
+        start = bench_wall_seconds();
+        if (want == 16) {
+            while (ffs_scan_plan(plan, buffer, fsize, &offset,
+                    &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
+                    &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+                    &rec.field_float, &rec.field_ldouble, rec.token,
+                    &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second) == want)
+                ;
+        } else {
+            while (ffs_scan_plan(plan, buffer, fsize, &offset,
+                    &rec.pn_prog, &rec.field_int, &rec.year, &rec.hour) == want)
+                ;
+        }
+        double tPlan = bench_wall_seconds() - start;
+        ffs_free_plan(plan);
+
+        printf("%-26s %14.1f %14.1f %14.1f  (%lu record)\n",
+               proj[k].label, mb / tC, mb / tCpp, mb / tPlan, count);
+    }
+    free(buffer);
+
+    /* a 70 character token, longer than Record.token: a projection has to
+       accept the record exactly when the full read does (the C reader stops
+       after 63 characters and fails the record, %s consumes the whole token) */
+    char line[160 + IO_PADDING];
+    memset(line, 0, sizeof(line));
+    int len = snprintf(line, 160, ":1[2]( 3 4 5 6 7 8.5 9.5 %070d 01/02/2020 03:04:05\n", 0);
+    int last = (int)(sizeof(proj) / sizeof(proj[0])) - 1;
+    BOOL same = TRUE;
+    BOOL full[3];
+    for (int k = last; k >= 0; --k) {
+        int want = (proj[k].fields == REC_ALL_FIELDS) ? 16 : (proj[k].fields == REC_PN_PROG) ? 1 : 4;
+        MyIO io;
+        memset(&io, 0, sizeof(io));
+        io.buffer = io.ptr = line;
+        io.end = line + len;
+        FfsPlan *plan = ffs_compile(proj[k].format);
+        BOOL got[3] = {
+            read_record_projected(&io, &rec, proj[k].fields),
+            scanProjected(line, (size_t)len, proj[k].format, NULL, want, &rec),
+            plan && scanProjected(line, (size_t)len, proj[k].format, plan, want, &rec)
+        };
+        ffs_free_plan(plan);
+        for (int j = 0; j < 3; ++j) {
+            if (k == last) full[j] = got[j];
+            else if (got[j] != full[j]) same = FALSE;
+        }
+    }
+    printf("%-26s C %s, C++ and plan %s%s\n", "70 character token",
+           full[0] ? "accepts" : "rejects", full[1] ? "accept" : "reject",
+           same && full[1] == full[2] ? " with every projection" : ", MISMATCH between projections");
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Keeps rec when every predicate holds; the baseline of test_predicates */
+static BOOL recordMatches(const Record *rec, const FfsPredicate *preds, int npreds) {
+    for (int i = 0; i < npreds; ++i) {
+        double v;
+        switch (preds[i].field) {
+            case 0:  v = (double)rec->pn_prog; break;
+            case 4:  v = rec->field_int; break;
+            case 12: v = rec->year; break;
+            default: return FALSE;
+        }
+        if (v < preds[i].lo || v > preds[i].hi) return FALSE;
+    }
+    return TRUE;
+}
+
+/* Predicate pushdown: parse everything and filter afterwards vs. checking the
+   predicates in ffs_scan_plan_filtered and skipping the rest of a rejected
+   line. Field numbers are the REC_* bit positions */
+static void test_predicates(const char *filename)
+{
+    size_t fsize;
+    char *buffer = loadWholeFile(filename, &fsize);
+    double mb = (double)fsize / (1024.0 * 1024.0);
+    FfsPlan *plan = ffs_compile(
+        ":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s "
+        "%hd/%hd/%hd %hd:%hd:%hd\n");
+    if (!plan) {
+        fprintf(stderr, "ffs_compile failed\n");
+        exit(1);
+    }
+    Record rec;
+
+    /* the thresholds come from the data, whatever the generator seed: the
+       99th percentile of pn_prog and field_int keeps about 1% of the records */
+    size_t cap = ffs_index_lines(buffer, fsize, NULL, 0);
+    double *progs = (double*)malloc((cap + 1) * sizeof(double));
+    double *ints = (double*)malloc((cap + 1) * sizeof(double));
+    if (!progs || !ints) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    unsigned long total = 0;
+    size_t offset = 0;
+    while (total <= cap && ffs_scan_plan(plan, buffer, fsize, &offset,
+            &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
+            &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+            &rec.field_float, &rec.field_ldouble, rec.token,
+            &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second) == 16)
+    {
+        progs[total] = (double)rec.pn_prog;
+        ints[total] = rec.field_int;
+        total++;
+    }
+    qsort(progs, total, sizeof(double), compareDouble);
+    qsort(ints, total, sizeof(double), compareDouble);
+    size_t p99 = (size_t)(total * 0.99);
+    double topProg = total ? progs[p99] : 0;
+    double topInt = total ? ints[p99] : 0;
+    free(progs);
+    free(ints);
+
+    /* every generated record is dated 2020: rejects nothing, the worst case */
+    const struct {
+        const char *label;
+        FfsPredicate pred;
+    } cases[] = {
+        { "pn_prog in top 1%",    { 0, topProg, 1e300 } },
+        { "field_int in top 1%",  { 4, topInt, 1e300 } },
+        { "year == 2020 (worst)", { 12, 2020, 2020 } },
+    };
+
+    printf("%-22s %16s %16s\n", "predicate", "filter after", "pushdown");
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k) {
+        unsigned long kept = 0;
+        offset = 0;
+        double start = bench_wall_seconds();
+        while (ffs_scan_plan(plan, buffer, fsize, &offset,
+                &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
+                &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+                &rec.field_float, &rec.field_ldouble, rec.token,
+                &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second) == 16)
+        {
+            if (recordMatches(&rec, &cases[k].pred, 1))
+                kept++;
+        }
+        double tAfter = bench_wall_seconds() - start;
+
+        unsigned long keptPushed = 0;
+        int rc;
+        offset = 0;
+        start = bench_wall_seconds();
+        while ((rc = ffs_scan_plan_filtered(plan, &cases[k].pred, 1, buffer, fsize, &offset,
+                &rec.pn_prog, &rec.pn_n, &rec.field_short, &rec.field_ushort,
+                &rec.field_int, &rec.field_hexushort, &rec.field_hexulong,
+                &rec.field_float, &rec.field_ldouble, rec.token,
+                &rec.day, &rec.month, &rec.year, &rec.hour, &rec.minute, &rec.second)) == 16
+               || rc == FFS_REJECTED)
+        {
+            if (rc == 16)
+                keptPushed++;
+        }
+        double tPushed = bench_wall_seconds() - start;
+
+        printf("%-22s %10.1f MB/s %10.1f MB/s  (%lu of %lu record kept%s)\n",
+               cases[k].label, mb / tAfter, mb / tPushed, keptPushed, total,
+               kept == keptPushed ? "" : ", MISMATCH");
+    }
+    ffs_free_plan(plan);
+    free(buffer);
+}
+
+/* Zero-copy tokens: every record of the file into a Record array (token
+   copied into token[64]) vs a RecordView array (pointer + length into the
+   buffer), with the C reader and the C++ template front-end */
+static void test_views(const char *filename)
+{
+    size_t fsize;
+    char *buffer = loadWholeFile(filename, &fsize);
+    size_t cap = ffs_index_lines(buffer, fsize, NULL, 0);
+    Record *recs = (Record*)malloc((cap + 1) * sizeof(Record));
+    RecordView *views = (RecordView*)malloc((cap + 1) * sizeof(RecordView));
+    if (!recs || !views) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    for (int cpp = 0; cpp <= 1; ++cpp) {
+        size_t n = 0, offset = 0;
+        MyIO io;
+        memset(&io, 0, sizeof(io));
+        io.buffer = io.ptr = buffer;
+        io.end = buffer + fsize;
+        double start = bench_wall_seconds();
+        if (cpp)
+            while (n < cap && fast_scan_record(buffer, fsize, &offset, &recs[n]) == 16) n++;
+        else
+            while (n < cap && read_record_custom(&io, &recs[n])) n++;
+        double tCopy = bench_wall_seconds() - start;
+
+        size_t nv = 0;
+        offset = 0;
+        io.ptr = buffer;
+        start = bench_wall_seconds();
+        if (cpp)
+            while (nv < cap && fast_scan_record_view(buffer, fsize, &offset, &views[nv]) == 16) nv++;
+        else
+            while (nv < cap && read_record_view(&io, &views[nv])) nv++;
+        double tView = bench_wall_seconds() - start;
+
+        printf("%-8s Record[]: %.3f s, %.1f MB   RecordView[]: %.3f s, %.1f MB  (%zu/%zu record)\n",
+               cpp ? "C++" : "C", tCopy, (double)(n * sizeof(Record)) / (1024.0 * 1024.0),
+               tView, (double)(nv * sizeof(RecordView)) / (1024.0 * 1024.0), n, nv);
+    }
+    free(recs);
+    free(views);
+    free(buffer);
+}
+
+/* Main function - creates test file if needed, then runs benchmarks
+   (fscanfasta --help for the options) */
+int main(int argc, char *argv[]) {
+    Options opt;
+    if (!parseOptions(argc, argv, &opt))
+        return 2;
+    const char *filename = opt.filename;
+    /* keep stdout machine-readable when the results go there */
+    FILE *info = (opt.output != OUTPUT_TEXT && !opt.results) ? stderr : stdout;
+
+    FILE *fcheck = opt.generate ? NULL : fopen(filename, "r");
+    if (!fcheck) {
+        fprintf(info, "Generating test file '%s' (~%zu byte)...\n", filename, opt.size);
+        create_test_file(filename, opt.size, opt.seed, opt.threads);
+    } else {
+        fclose(fcheck);
+        fprintf(info, "Test file '%s' already existing.\n", filename);
+    }
+
+    if (opt.methods) {
+        fprintf(info, "\nParse methods (wall clock)\n");
+        test_methods(&opt, info);
+    }
+
+    if (opt.tests & TEST_LOAD) {
+        printf("\nLoaders: read into a buffer vs mmap (wall clock)\n");
+        test_load(filename, "fscanfasta[C] read", -1, FALSE);
+        test_load(filename, "fscanfasta[C] mmap", 0, FALSE);
+        test_load(filename, "fscanfasta[C] mmap+populate", IO_MAP_POPULATE, FALSE);
+        test_load(filename, "fscanfasta[C++ tmpl] read", -1, TRUE);
+        test_load(filename, "fscanfasta[C++ tmpl] mmap", 0, TRUE);
+        test_load(filename, "fscanfasta[C++ tmpl] mmap+hp", IO_MAP_HUGEPAGES, TRUE);
+    }
+
+    if (opt.tests & TEST_STREAM) {
+        printf("\nStreaming: bounded memory, double-buffered chunks (wall clock)\n");
+        test_stream(filename, 0, FALSE);
+        test_stream(filename, 0, TRUE);
+    }
+
+    if (opt.tests & TEST_PARALLEL) {
+        printf("\nParallel: newline-aligned chunks, one per thread (wall clock)\n");
+        test_parallel(filename, FALSE, opt.threads);
+        test_parallel(filename, TRUE, opt.threads);
+    }
+
+    if (opt.tests & TEST_INDEX) {
+        printf("\nSidecar index: random access by record number (wall clock)\n");
+        test_index_range(filename, 1000);
+    }
+
+    if (opt.tests & TEST_CACHE) {
+        printf("\nSnapshot cache of parsed records (wall clock)\n");
+        test_record_cache(filename);
+    }
+
+    if (opt.tests & TEST_COLUMNS) {
+        printf("\nColumnar batches vs Record array (wall clock)\n");
+        test_columns(filename);
+    }
+
+    if (opt.tests & TEST_PROJECTION) {
+        printf("\nProjection pushdown: convert only the selected fields (wall clock)\n");
+        test_projection(filename);
+    }
+
+    if (opt.tests & TEST_PREDICATES) {
+        printf("\nPredicate pushdown: reject records while parsing (wall clock)\n");
+        test_predicates(filename);
+    }
+
+    if (opt.tests & TEST_VIEWS) {
+        printf("\nZero-copy tokens: Record vs RecordView arrays (wall clock)\n");
+        test_views(filename);
+    }
 
     return 0;
 }
 
+#endif /* FSCANFASTA_NO_MAIN */
+
 /*
 BUILD COMMANDS
 Open the Start Menu, search for “Developer Command Prompt” 
 cd /D path
-cl /EHsc /O2 /std:c++20 fast_fscanf.cpp fscanfasta.c /Fe:fscanfasta.exe
+cl /EHsc /O2 /std:c++20 fast_fscanf.cpp record_scan.cpp fscanfasta.c line_index.c record_cache.c bench.c /Fe:fscanfasta.exe
 
 RUN COMMANDS
 Open folder in terminal
@@ -0,0 +1,192 @@
+/* fscanfasta.h - record type and I/O functions shared by the C and C++ code */
+#ifndef FSCANFASTA_H
+#define FSCANFASTA_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Boolean type for better readability */
+typedef int BOOL;
+#define TRUE 1
+#define FALSE 0
+
+/* I/O structure that handles both file and memory-based operations */
+typedef struct {
+    FILE *fp;          /* File pointer (file mode) */
+    char *buffer;      /* Memory buffer (memory mode) */
+    char *ptr;         /* Current position in buffer */
+    char *end;         /* End of buffer */
+    size_t size;       /* Buffer size */
+    BOOL useFile;      /* Mode flag (TRUE = file, FALSE = memory) */
+    BOOL mapped;       /* buffer is a file mapping (ioOpenMapped), not malloc'd */
+    void *stream;      /* Streaming state (ioOpenStream), NULL otherwise */
+} MyIO;
+
+/* Zero bytes every loader puts after the data (loadFileIntoBuffer,
+   ioMapFile/ioOpenMapped, the ioOpenStream windows): the parsing kernels
+   load whole words and vectors across the end of the input */
+#define IO_PADDING 64
+
+/* Default ioOpenStream window: bytes per chunk buffer */
+#define IO_STREAM_WINDOW (16u << 20)
+
+/* ioOpenMapped / ioMapFile flags */
+#define IO_MAP_POPULATE  1  /* prefault the whole mapping up front (MAP_POPULATE) */
+#define IO_MAP_HUGEPAGES 2  /* ask for transparent huge pages (MADV_HUGEPAGE) */
+
+/* Date structure (g=day, m=month, a=year) */
+struct data {
+    char g;
+    char m;
+    short a;
+};
+
+/* Time structure (o=hour, m=minute, s=second) */
+struct ora {
+    char o;
+    char m;
+    char s;
+};
+
+/* Test record structure with various field types */
+typedef struct {
+    unsigned long pn_prog;      /* Progressive number */
+    short pn_n;                 /* Secondary identifier */
+    short field_short;          
+    unsigned short field_ushort;
+    int field_int;              
+    unsigned short field_hexushort; /* Hex format */
+    unsigned long field_hexulong;   /* Hex format */
+    float field_float;          
+    long double field_ldouble;  
+    char token[64];             /* String token */
+    short day, month, year;     /* Date components */
+    short hour, minute, second; /* Time components */
+} Record;
+
+/* Record whose token stays in the parsed buffer (read_record_view,
+   fast_scan_record_view): a pointer and a length instead of a 64-byte
+   copy. The token is valid as long as that buffer is, and has its quotes
+   stripped only by the C reader, like Record.token */
+typedef struct {
+    unsigned long pn_prog;
+    short pn_n;
+    short field_short;
+    unsigned short field_ushort;
+    int field_int;
+    unsigned short field_hexushort;
+    unsigned long field_hexulong;
+    float field_float;
+    long double field_ldouble;
+    const char *token;          /* not NUL-terminated */
+    size_t token_len;
+    short day, month, year;
+    short hour, minute, second;
+} RecordView;
+
+/* Column-wise (struct-of-arrays) batch of records, see read_record_columns.
+   Each field is its own array, so scanning one column only touches that
+   column's bytes; the token stays in the parsed buffer as offset + length. */
+typedef struct {
+    size_t count;                     /* rows decoded by the last read_record_columns */
+    size_t capacity;                  /* rows allocated */
+    size_t rowGroup;                  /* rows per batch, 0 = everything */
+    unsigned long *pn_prog;
+    short *pn_n;
+    short *field_short;
+    unsigned short *field_ushort;
+    int *field_int;
+    unsigned short *field_hexushort;
+    unsigned long *field_hexulong;
+    float *field_float;
+    long double *field_ldouble;
+    size_t *token_offset;             /* into the buffer given to read_record_columns */
+    unsigned int *token_length;
+    short *day, *month, *year;
+    short *hour, *minute, *second;
+} RecordColumns;
+
+/* ============== I/O basic functions (fscanfasta.c) ============== */
+
+BOOL loadFileIntoBuffer(FILE *fp, const char *filename, MyIO *io, BOOL loadBuffer);
+BOOL ioOpen(MyIO *io, const char *filename, BOOL readAllInMemory);
+BOOL ioOpenMapped(MyIO *io, const char *filename, unsigned flags);
+char *ioMapFile(const char *filename, unsigned flags, size_t *size);
+void ioUnmapFile(char *base, size_t size);
+BOOL ioOpenStream(MyIO *io, const char *filename, size_t window);
+BOOL ioRefill(MyIO *io);
+BOOL ioStreamError(const MyIO *io);
+void ioClose(MyIO *io);
+BOOL ioSkipLine(MyIO *io);
+BOOL ioReadShort(MyIO *io, short *out);
+BOOL ioReadUShort(MyIO *io, unsigned short *out);
+BOOL ioReadInt(MyIO *io, int *out);
+BOOL ioReadHexUShort(MyIO *io, unsigned short *out);
+BOOL ioReadHexULong(MyIO *io, unsigned long *out);
+BOOL ioReadChar(MyIO *io, char *out);
+BOOL ioReadToken(MyIO *io, char *outBuffer, size_t maxLen);
+BOOL ioReadTokenView(MyIO *io, const char **token, size_t *len);
+BOOL ioReadData(MyIO *io, struct data *pdata);
+BOOL ioReadOra(MyIO *io, struct ora *pora);
+BOOL ioReadFloat(MyIO *io, float *out);
+BOOL ioReadLongDouble(MyIO *io, long double *out);
+
+/* ============== Record read functions ============== */
+
+/* Field selection for read_record_projected: one bit per Record field */
+#define REC_PN_PROG         (1u << 0)
+#define REC_PN_N            (1u << 1)
+#define REC_FIELD_SHORT     (1u << 2)
+#define REC_FIELD_USHORT    (1u << 3)
+#define REC_FIELD_INT       (1u << 4)
+#define REC_FIELD_HEXUSHORT (1u << 5)
+#define REC_FIELD_HEXULONG  (1u << 6)
+#define REC_FIELD_FLOAT     (1u << 7)
+#define REC_FIELD_LDOUBLE   (1u << 8)
+#define REC_TOKEN           (1u << 9)
+#define REC_DAY             (1u << 10)
+#define REC_MONTH           (1u << 11)
+#define REC_YEAR            (1u << 12)
+#define REC_HOUR            (1u << 13)
+#define REC_MINUTE          (1u << 14)
+#define REC_SECOND          (1u << 15)
+#define REC_ALL_FIELDS      0xFFFFu
+
+BOOL read_record_custom(MyIO *io, Record *rec);
+BOOL read_record_projected(MyIO *io, Record *rec, unsigned fields);
+BOOL read_record_view(MyIO *io, RecordView *rec);
+
+/* Parses one record with the compile-time fscanfasta::scan front-end (record_scan.cpp).
+   Returns the number of matched fields, 16 for a complete record. */
+int fast_scan_record(const char *buffer, size_t size, size_t *offset, Record *rec);
+/* Same, with the token returned as a view (%S) */
+int fast_scan_record_view(const char *buffer, size_t size, size_t *offset, RecordView *rec);
+
+/* Columnar batches (record_scan.cpp). rowGroup is the number of rows per
+   read_record_columns call, or 0 to decode the whole buffer in one call
+   (the columns then grow as needed). init returns FALSE when out of memory */
+BOOL record_columns_init(RecordColumns *cols, size_t rowGroup);
+void record_columns_free(RecordColumns *cols);
+
+/* Decodes the records of buffer[*offset .. size) into the columns, up to
+   one row group, and advances *offset past them. Rows start at index 0 on
+   every call; returns the number of rows decoded (cols->count), 0 at the
+   end of the buffer or at the first malformed record */
+size_t read_record_columns(const char *buffer, size_t size, size_t *offset, RecordColumns *cols);
+
+/* Parses all records of buffer on 'threads' threads, with read_record_custom
+   (cpp == FALSE) or fast_scan_record (cpp == TRUE). If out is not NULL it
+   receives a malloc'd array of the records in file order.
+   Returns the number of records. */
+unsigned long read_records_parallel(const char *buffer, size_t size, int threads,
+                                    BOOL cpp, Record **out);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* FSCANFASTA_H */
@@ -0,0 +1,300 @@
+/* line_index.c - persistent sidecar line index
+ *
+ * <file>.idx lets a reader jump to record N of <file> without scanning it.
+ * Layout (host byte order; a foreign or stale file is rejected by the
+ * header checks and simply rebuilt):
+ *
+ *   LineIndexHeader
+ *   LineIndexBlock[blocks]   absolute offset of every LINE_INDEX_BLOCK-th
+ *                            line and where its deltas start in the data
+ *   uint8_t data[dataBytes]  for the other lines of each block, the distance
+ *                            from the previous line start as a LEB128 varint
+ *
+ * With ~100 byte records that is about 1.25 bytes per record, and a lookup
+ * costs one table read plus at most LINE_INDEX_BLOCK - 1 varints.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "line_index.h"
+#include "ffs_kernels.h"
+
+#define LINE_INDEX_MAGIC "FFSIDX1"
+
+typedef struct {
+    char magic[8];
+    uint64_t fileSize;     /* size of the indexed file ... */
+    int64_t fileMtime;     /* ... and its mtime when it was indexed */
+    uint64_t lines;
+    uint64_t blocks;
+    uint64_t dataBytes;
+    uint32_t blockLines;
+    uint32_t reserved;
+} LineIndexHeader;
+
+typedef struct {
+    uint64_t offset;       /* first line of the block */
+    uint64_t dataPos;      /* its deltas in data[] */
+} LineIndexBlock;
+
+struct LineIndex {
+    LineIndexHeader hdr;
+    LineIndexBlock *blocks;
+    unsigned char *data;
+};
+
+/* Size and mtime of a file; FALSE if it cannot be stat'ed */
+static BOOL fileStamp(const char *filename, uint64_t *size, int64_t *mtime) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(filename, &st) != 0) return FALSE;
+#else
+    struct stat st;
+    if (stat(filename, &st) != 0) return FALSE;
+#endif
+    *size = (uint64_t)st.st_size;
+    *mtime = (int64_t)st.st_mtime;
+    return TRUE;
+}
+
+/* filename + ".idx" (+ suffix), malloc'd */
+static char *indexPath(const char *filename, const char *suffix) {
+    size_t len = strlen(filename);
+    char *path = (char*)malloc(len + 4 + strlen(suffix) + 1);
+    if (!path) return NULL;
+    memcpy(path, filename, len);
+    strcpy(path + len, ".idx");
+    strcat(path + len, suffix);
+    return path;
+}
+
+/* ============== Building ============== */
+
+typedef struct {
+    LineIndexBlock *blocks;
+    size_t blockCap;
+    unsigned char *data;
+    size_t dataCap;
+    uint64_t lines, blocks_n, dataBytes;
+    uint64_t prev;
+} IndexBuilder;
+
+/* Appends the start offset of the next line */
+static BOOL builderAdd(IndexBuilder *b, uint64_t start) {
+    if (b->lines % LINE_INDEX_BLOCK == 0) {
+        if (b->blocks_n == b->blockCap) {
+            size_t cap = b->blockCap ? b->blockCap * 2 : 1024;
+            LineIndexBlock *nb = (LineIndexBlock*)realloc(b->blocks, cap * sizeof(*nb));
+            if (!nb) return FALSE;
+            b->blocks = nb;
+            b->blockCap = cap;
+        }
+        b->blocks[b->blocks_n].offset = start;
+        b->blocks[b->blocks_n].dataPos = b->dataBytes;
+        b->blocks_n++;
+    }
+    else {
+        if (b->dataCap - b->dataBytes < 10) {
+            size_t cap = b->dataCap ? b->dataCap * 2 : 65536;
+            unsigned char *nd = (unsigned char*)realloc(b->data, cap);
+            if (!nd) return FALSE;
+            b->data = nd;
+            b->dataCap = cap;
+        }
+        uint64_t delta = start - b->prev;
+        while (delta >= 0x80) {
+            b->data[b->dataBytes++] = (unsigned char)(delta | 0x80);
+            delta >>= 7;
+        }
+        b->data[b->dataBytes++] = (unsigned char)delta;
+    }
+    b->prev = start;
+    b->lines++;
+    return TRUE;
+}
+
+/* Scans the file in chunks with the SIMD newline search: a line start is
+   recorded once a byte is known to follow it, so a final '\n' does not
+   open an empty last line */
+static BOOL scanLines(FILE *fp, IndexBuilder *b, uint64_t *total) {
+    enum { CHUNK = 1 << 20 };
+    char *buf = (char*)malloc(CHUNK + FFS_PADDING);    /* ffs_find_char over-reads */
+    if (!buf) return FALSE;
+    uint64_t base = 0, pending = 0;
+    BOOL ok = TRUE;
+    size_t rd;
+    while (ok && (rd = fread(buf, 1, CHUNK, fp)) > 0) {
+        const char *p = buf, *end = buf + rd;
+        while ((p = ffs_find_char(p, end, '\n')) < end) {
+            if (!builderAdd(b, pending)) {
+                ok = FALSE;
+                break;
+            }
+            pending = base + (uint64_t)(p - buf) + 1;
+            p++;
+        }
+        base += rd;
+    }
+    if (ok && ferror(fp)) ok = FALSE;
+    if (ok && pending < base) ok = builderAdd(b, pending);
+    free(buf);
+    *total = base;
+    return ok;
+}
+
+/* Scans filename and writes filename.idx (through a temporary file, so a
+   reader never sees a half-written index). Returns TRUE on success */
+BOOL line_index_build(const char *filename) {
+    if (!filename) return FALSE;
+    uint64_t size;
+    int64_t mtime;
+    if (!fileStamp(filename, &size, &mtime)) return FALSE;
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return FALSE;
+
+    IndexBuilder b;
+    memset(&b, 0, sizeof(b));
+    uint64_t total = 0;
+    BOOL ok = scanLines(fp, &b, &total);
+    fclose(fp);
+    ok = ok && total == size;    /* changed while we were reading it */
+
+    char *tmp = indexPath(filename, ".tmp");
+    char *path = indexPath(filename, "");
+    FILE *out = (ok && tmp && path) ? fopen(tmp, "wb") : NULL;
+    if (out) {
+        LineIndexHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, LINE_INDEX_MAGIC, sizeof(LINE_INDEX_MAGIC));
+        hdr.fileSize = size;
+        hdr.fileMtime = mtime;
+        hdr.lines = b.lines;
+        hdr.blocks = b.blocks_n;
+        hdr.dataBytes = b.dataBytes;
+        hdr.blockLines = LINE_INDEX_BLOCK;
+        ok = fwrite(&hdr, sizeof(hdr), 1, out) == 1 &&
+             fwrite(b.blocks, sizeof(LineIndexBlock), b.blocks_n, out) == b.blocks_n &&
+             fwrite(b.data, 1, b.dataBytes, out) == b.dataBytes;
+        ok = (fclose(out) == 0) && ok;
+        if (ok) {
+            remove(path);    /* rename does not replace on Windows */
+            ok = (rename(tmp, path) == 0);
+        }
+        if (!ok) remove(tmp);
+    }
+    else {
+        ok = FALSE;
+    }
+    free(tmp);
+    free(path);
+    free(b.blocks);
+    free(b.data);
+    return ok;
+}
+
+/* ============== Loading and lookups ============== */
+
+/* Reads filename.idx and checks it against the current file */
+static LineIndex *loadIndex(const char *filename) {
+    uint64_t size;
+    int64_t mtime;
+    if (!fileStamp(filename, &size, &mtime)) return NULL;
+    char *path = indexPath(filename, "");
+    if (!path) return NULL;
+    FILE *fp = fopen(path, "rb");
+    free(path);
+    if (!fp) return NULL;
+
+    LineIndex *idx = (LineIndex*)calloc(1, sizeof(LineIndex));
+    BOOL ok = idx && fread(&idx->hdr, sizeof(idx->hdr), 1, fp) == 1;
+    LineIndexHeader *h = ok ? &idx->hdr : NULL;
+    ok = ok && memcmp(h->magic, LINE_INDEX_MAGIC, sizeof(LINE_INDEX_MAGIC)) == 0 &&
+         h->blockLines == LINE_INDEX_BLOCK &&
+         h->fileSize == size && h->fileMtime == mtime &&
+         h->blocks == (h->lines + LINE_INDEX_BLOCK - 1) / LINE_INDEX_BLOCK &&
+         h->blocks <= SIZE_MAX / sizeof(LineIndexBlock) && h->dataBytes <= SIZE_MAX;
+    if (ok) {
+        idx->blocks = (LineIndexBlock*)malloc((size_t)h->blocks * sizeof(LineIndexBlock) + 1);
+        idx->data = (unsigned char*)malloc((size_t)h->dataBytes + 1);
+        ok = idx->blocks && idx->data &&
+             fread(idx->blocks, sizeof(LineIndexBlock), (size_t)h->blocks, fp) == h->blocks &&
+             fread(idx->data, 1, (size_t)h->dataBytes, fp) == h->dataBytes &&
+             fgetc(fp) == EOF;
+    }
+    /* block i's deltas lie in [dataPos, next block's dataPos), offsets ascend */
+    for (uint64_t i = 0; ok && i < h->blocks; ++i) {
+        const LineIndexBlock *blk = &idx->blocks[i];
+        BOOL last = (i + 1 == h->blocks);
+        ok = (last ? blk->dataPos <= h->dataBytes : blk->dataPos < blk[1].dataPos) &&
+             blk->offset <= h->fileSize && (i == 0 || blk[-1].offset < blk->offset);
+    }
+    fclose(fp);
+    if (!ok) {
+        line_index_close(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+/* Loads filename.idx if it matches the current size and mtime of filename,
+   rebuilding it first when asked to and it does not */
+LineIndex *line_index_open(const char *filename, BOOL build) {
+    if (!filename) return NULL;
+    LineIndex *idx = loadIndex(filename);
+    if (!idx && build && line_index_build(filename))
+        idx = loadIndex(filename);
+    return idx;
+}
+
+void line_index_close(LineIndex *idx) {
+    if (!idx) return;
+    free(idx->blocks);
+    free(idx->data);
+    free(idx);
+}
+
+size_t line_index_count(const LineIndex *idx) {
+    return (size_t)idx->hdr.lines;
+}
+
+/* Byte offset of line n: the block's offset plus up to 63 varint deltas.
+   FALSE when the deltas run past the block or past the end of the file */
+BOOL line_index_offset(const LineIndex *idx, size_t n, size_t *offset) {
+    if (n >= idx->hdr.lines) {
+        *offset = (size_t)idx->hdr.fileSize;
+        return TRUE;
+    }
+    size_t b = n / LINE_INDEX_BLOCK;
+    const LineIndexBlock *blk = &idx->blocks[b];
+    uint64_t off = blk->offset;
+    const unsigned char *p = idx->data + blk->dataPos;
+    const unsigned char *end = idx->data +
+        ((b + 1 < idx->hdr.blocks) ? blk[1].dataPos : idx->hdr.dataBytes);
+    for (size_t i = n % LINE_INDEX_BLOCK; i > 0; --i) {
+        uint64_t delta = 0;
+        int shift = 0;
+        unsigned char c;
+        do {
+            if (p == end || shift > 63) return FALSE;
+            c = *p++;
+            delta |= (uint64_t)(c & 0x7F) << shift;
+            shift += 7;
+        } while (c & 0x80);
+        off += delta;
+        if (off > idx->hdr.fileSize) return FALSE;
+    }
+    *offset = (size_t)off;
+    return TRUE;
+}
+
+BOOL line_index_range(const LineIndex *idx, size_t first, size_t count,
+                      size_t *begin, size_t *end) {
+    size_t lines = (size_t)idx->hdr.lines;
+    if (first >= lines) return FALSE;
+    if (count > lines - first) count = lines - first;
+    return line_index_offset(idx, first, begin) &&
+           line_index_offset(idx, first + count, end);
+}
@@ -0,0 +1,45 @@
+/* line_index.h - persistent sidecar line index (<file>.idx), see line_index.c */
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <stddef.h>
+
+#include "fscanfasta.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Lines per block: one absolute offset is stored per block, the other lines
+   of the block as varint deltas, so a lookup decodes at most 63 deltas */
+#define LINE_INDEX_BLOCK 64
+
+typedef struct LineIndex LineIndex;
+
+/* Scans filename and writes filename.idx. Returns TRUE on success */
+BOOL line_index_build(const char *filename);
+
+/* Loads filename.idx if it matches the current size and mtime of filename.
+   With build == TRUE a missing or stale index is rebuilt first.
+   Returns NULL when there is no valid index (or on error) */
+LineIndex *line_index_open(const char *filename, BOOL build);
+void line_index_close(LineIndex *idx);
+
+/* Number of lines (records) in the indexed file */
+size_t line_index_count(const LineIndex *idx);
+
+/* *offset = byte offset of line n; line_index_count() gives the file size.
+   Returns FALSE when the index data for line n is corrupt */
+BOOL line_index_offset(const LineIndex *idx, size_t n, size_t *offset);
+
+/* Byte range [*begin, *end) of lines first .. first+count-1, clamped to the
+   file. Returns FALSE when first is past the last line or the index is
+   corrupt */
+BOOL line_index_range(const LineIndex *idx, size_t first, size_t count,
+                      size_t *begin, size_t *end);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* LINE_INDEX_H */
@@ -0,0 +1,988 @@
+// microbench.cpp
+//
+// Standalone micro-benchmarks for the parsing kernels and for every
+// conversion of fast_fscanf_mem and the ioRead* functions, on pre-generated
+// in-memory inputs. fscanfasta.c is linked as a library, without its main:
+//
+//   gcc -O2 -DFSCANFASTA_NO_MAIN -c fscanfasta.c -o fscanfasta_lib.o
+//   gcc -O2 -c line_index.c record_cache.c bench.c
+//   g++ -O2 -std=c++20 -pthread microbench.cpp fast_fscanf.cpp record_scan.cpp
+//       fscanfasta_lib.o line_index.o record_cache.o bench.o -o microbench
+//   ./microbench
+//
+// (MSVC: cl /EHsc /O2 /std:c++20 /DFSCANFASTA_NO_MAIN microbench.cpp fast_fscanf.cpp
+//  record_scan.cpp fscanfasta.c line_index.c record_cache.c bench.c /Fe:microbench.exe)
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ffs_kernels.h"
+#include "fscanfasta.h"
+#include "fast_fscanf.h"
+
+// -------------------------------------------------------------------------
+// Helpers
+// -------------------------------------------------------------------------
+
+static const size_t kCount = 1000000;  // numbers per input
+static const int    kRuns  = 5;        // best of
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+/** Inputs end with the FFS_PADDING bytes the kernels may read past the
+    text; the text itself is textSize() bytes. */
+static std::string padded(std::string s)
+{
+    s.append(FFS_PADDING, '\0');
+    return s;
+}
+
+static size_t textSize(const std::string &input)
+{
+    return input.size() - FFS_PADDING;
+}
+
+/** Sink so that the compiler cannot drop the parsed values. */
+static volatile uint64_t g_sink;
+
+/**
+ * Runs parseOne over every number of the input, kRuns times, and returns the
+ * best time in nanoseconds per number. parseOne(p, end, value) advances p past
+ * one number and the separator that follows it, returning false on error.
+ */
+template <class F>
+static double runBench(const std::string &input, size_t count, F parseOne)
+{
+    double best = 1e30;
+    for (int run = 0; run < kRuns; ++run) {
+        const char *p   = input.data();
+        const char *end = input.data() + textSize(input);
+        uint64_t sum = 0;
+        double t0 = nowSeconds();
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t v = 0;
+            if (!parseOne(p, end, v)) {
+                fprintf(stderr, "parse error at number %zu\n", i);
+                exit(1);
+            }
+            sum += v;
+        }
+        double t = nowSeconds() - t0;
+        g_sink = sum;
+        if (t < best) best = t;
+    }
+    return best * 1e9 / (double)count;
+}
+
+// -------------------------------------------------------------------------
+// Decimal integers: %d %u %hd %hu %ld %lu
+// -------------------------------------------------------------------------
+
+/** 'count' space-separated decimal numbers of exactly 'digits' digits, or of
+    1..-digits digits picked at random when 'digits' is negative. */
+static std::string makeDecimalInput(int digits, size_t count, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string s;
+    int maxDigits = digits < 0 ? -digits : digits;
+    s.reserve(count * (maxDigits + 1));
+    for (size_t i = 0; i < count; ++i) {
+        int len = digits < 0 ? 1 + (int)(rng() % maxDigits) : digits;
+        for (int d = 0; d < len; ++d) {
+            int c;
+            if (d == 0)
+                c = (len == 20) ? 1 : 1 + (int)(rng() % 9);  // no leading zero
+            else if (d == 1 && len == 20)
+                c = (int)(rng() % 8);                 // stay below 2^64
+            else
+                c = (int)(rng() % 10);
+            s += (char)('0' + c);
+        }
+        s += ' ';
+    }
+    return padded(std::move(s));
+}
+
+/** The previous fast_fscanf_mem path: copy the digits into a zeroed token
+    buffer, terminating after each one, then strlen + from_chars. */
+static bool legacyTokenParse(const char *&p, const char *end, uint64_t &out)
+{
+    char tok[128] = {0};
+    size_t pos = 0;
+    bool gotDigit = false;
+    while (p < end && isdigit((unsigned char)*p)) {
+        if (pos < sizeof(tok) - 1) {
+            tok[pos++] = *p;
+            tok[pos]   = '\0';
+        }
+        p++;
+        gotDigit = true;
+    }
+    if (!gotDigit) return false;
+    unsigned long long val = 0;
+    auto r = std::from_chars(tok, tok + std::strlen(tok), val, 10);
+    if (r.ec != std::errc()) return false;
+    out = val;
+    p++;  // separator
+    return true;
+}
+
+static bool fromCharsParse(const char *&p, const char *end, uint64_t &out)
+{
+    unsigned long long val = 0;
+    auto r = std::from_chars(p, end, val, 10);
+    if (r.ec != std::errc()) return false;
+    out = val;
+    p = r.ptr + 1;
+    return true;
+}
+
+static bool swarParse(const char *&p, const char *end, uint64_t &out)
+{
+    const char *q = ffs_parse_u64(p, end, &out);
+    if (!q || q == p) return false;
+    p = q + 1;
+    return true;
+}
+
+static void benchDecimalRow(const char *label, int digits)
+{
+    std::string input = makeDecimalInput(digits, kCount, 42 + digits);
+    double tLegacy = runBench(input, kCount, legacyTokenParse);
+    double tFc     = runBench(input, kCount, fromCharsParse);
+    double tSwar   = runBench(input, kCount, swarParse);
+    printf("%6s %12.2f %12.2f %12.2f %7.2fx\n",
+           label, tLegacy, tFc, tSwar, tLegacy / tSwar);
+}
+
+static void benchDecimal()
+{
+    printf("decimal integers (ns/number)\n");
+    printf("%6s %12s %12s %12s %8s\n", "digits", "token+f_c", "from_chars", "swar", "speedup");
+    for (int digits = 1; digits <= 20; ++digits) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d", digits);
+        benchDecimalRow(label, digits);
+    }
+    // fixed lengths flatter the branchy loops; real fields vary in length
+    benchDecimalRow("1-7", -7);
+    benchDecimalRow("1-20", -20);
+    printf("\n");
+}
+
+// -------------------------------------------------------------------------
+// Hexadecimal integers: %x %hx %lx
+// -------------------------------------------------------------------------
+
+/** 'count' space-separated hex numbers of exactly 'digits' digits, or of
+    1..-digits digits when 'digits' is negative. */
+static std::string makeHexInput(int digits, size_t count, uint64_t seed)
+{
+    static const char hex[] = "0123456789abcdef";
+    std::mt19937_64 rng(seed);
+    std::string s;
+    int maxDigits = digits < 0 ? -digits : digits;
+    s.reserve(count * (maxDigits + 1));
+    for (size_t i = 0; i < count; ++i) {
+        int len = digits < 0 ? 1 + (int)(rng() % maxDigits) : digits;
+        for (int d = 0; d < len; ++d) {
+            s += hex[d == 0 ? 1 + rng() % 15 : rng() % 16];
+        }
+        s += ' ';
+    }
+    return padded(std::move(s));
+}
+
+static bool strtoullHexParse(const char *&p, const char *, uint64_t &out)
+{
+    char *endp;
+    out = strtoull(p, &endp, 16);
+    if (endp == p) return false;
+    p = endp + 1;
+    return true;
+}
+
+static bool fromCharsHexParse(const char *&p, const char *end, uint64_t &out)
+{
+    unsigned long long val = 0;
+    auto r = std::from_chars(p, end, val, 16);
+    if (r.ec != std::errc()) return false;
+    out = val;
+    p = r.ptr + 1;
+    return true;
+}
+
+static bool scalarHexParse(const char *&p, const char *end, uint64_t &out)
+{
+    const char *q = ffs_parse_hex_scalar(p, end, 0, &out);
+    if (!q || q == p) return false;
+    p = q + 1;
+    return true;
+}
+
+static bool simdHexParse(const char *&p, const char *end, uint64_t &out)
+{
+    const char *q = ffs_parse_hex_u64(p, end, &out);
+    if (!q || q == p) return false;
+    p = q + 1;
+    return true;
+}
+
+static void benchHexRow(const char *label, int digits)
+{
+    std::string input = makeHexInput(digits, kCount, 7 + digits);
+    double tStrtoull = runBench(input, kCount, strtoullHexParse);
+    double tFc       = runBench(input, kCount, fromCharsHexParse);
+    double tScalar   = runBench(input, kCount, scalarHexParse);
+    double tSimd     = runBench(input, kCount, simdHexParse);
+    printf("%6s %12.2f %12.2f %12.2f %12.2f %7.2fx\n",
+           label, tStrtoull, tFc, tScalar, tSimd, tFc / tSimd);
+}
+
+static void benchHex()
+{
+    printf("hex integers (ns/number, simd = %s)\n", FFS_SSE2 ? "SSE2" : "scalar fallback");
+    printf("%6s %12s %12s %12s %12s %8s\n",
+           "digits", "strtoull", "from_chars", "scalar", "simd", "vs f_c");
+    for (int digits = 1; digits <= 16; ++digits) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d", digits);
+        benchHexRow(label, digits);
+    }
+    benchHexRow("1-8", -8);
+    benchHexRow("1-16", -16);
+    printf("\n");
+}
+
+// -------------------------------------------------------------------------
+// Long double: %Lf
+// -------------------------------------------------------------------------
+
+/** 'count' space-separated long doubles. kind 0 is what create_test_file
+    writes (rec_no * 0.01 through "%Lf"), kind 1 varies the number of
+    fractional digits, kind 2 has long mantissas and exponents that the
+    exact fast path cannot take. */
+static std::string makeLongDoubleInput(int kind, size_t count, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string s;
+    char buf[64];
+    s.reserve(count * 24);
+    for (size_t i = 0; i < count; ++i) {
+        if (kind == 0)
+            snprintf(buf, sizeof(buf), "%Lf ", (long double)((rng() % 10000000) * 0.01));
+        else if (kind == 1)
+            snprintf(buf, sizeof(buf), "%.*Lf ", (int)(rng() % 10),
+                     (long double)(rng() % 100000000000ULL) / 1000);
+        else
+            snprintf(buf, sizeof(buf), "%d.%010llu%010llue%d ", 1 + (int)(rng() % 9),
+                     (unsigned long long)(rng() % 10000000000ULL),
+                     (unsigned long long)(rng() % 10000000000ULL), (int)(rng() % 80) - 40);
+        s += buf;
+    }
+    return padded(std::move(s));
+}
+
+static bool strtoldParse(const char *&p, const char *, uint64_t &out)
+{
+    char *endp;
+    long double v = strtold(p, &endp);
+    if (endp == p) return false;
+    out = (uint64_t)(int64_t)v;
+    p = endp + 1;
+    return true;
+}
+
+static bool ffsLongDoubleParse(const char *&p, const char *end, uint64_t &out)
+{
+    long double v;
+    const char *q = ffs_parse_long_double(p, end, &v);
+    if (!q || q == p) return false;
+    out = (uint64_t)(int64_t)v;
+    p = q + 1;
+    return true;
+}
+
+/** Percentage of the numbers in 'input' that ffs_parse_long_double_fast
+    converts without falling back to strtold. */
+static double longDoubleFastShare(const std::string &input, size_t count)
+{
+    const char *p   = input.data();
+    const char *end = input.data() + textSize(input);
+    size_t fast = 0;
+    for (size_t i = 0; i < count; ++i) {
+        long double v;
+        if (ffs_parse_long_double_fast(p, end, &v)) fast++;
+        while (*p != ' ') p++;
+        p++;
+    }
+    return 100.0 * (double)fast / (double)count;
+}
+
+static void benchLongDoubleRow(const char *label, int kind)
+{
+    std::string input = makeLongDoubleInput(kind, kCount, 11 + kind);
+    double tStrtold = runBench(input, kCount, strtoldParse);
+    double tFfs     = runBench(input, kCount, ffsLongDoubleParse);
+    printf("%10s %12.2f %12.2f %7.2fx %9.1f%%\n",
+           label, tStrtold, tFfs, tStrtold / tFfs, longDoubleFastShare(input, kCount));
+}
+
+static void benchLongDouble()
+{
+    printf("long double %%Lf (ns/number, LDBL_MANT_DIG = %d, exact up to 1e%d)\n",
+           LDBL_MANT_DIG, FFS_LDBL_MAX_POW10);
+    printf("%10s %12s %12s %8s %10s\n", "input", "strtold", "ffs", "speedup", "fast path");
+    benchLongDoubleRow("testdata", 0);
+    benchLongDoubleRow("0-9 frac", 1);
+    benchLongDoubleRow("21 digits", 2);
+    printf("\n");
+}
+
+// -------------------------------------------------------------------------
+// Line boundaries: ffs_index_lines, ffs_find_char
+// -------------------------------------------------------------------------
+
+/** About 'bytes' of text shaped like the test file: lines of 60..120
+    characters, with no more than a handful of '\n' per 64-byte block. */
+static std::string makeLinesInput(size_t bytes, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string s;
+    s.reserve(bytes + 128);
+    while (s.size() < bytes) {
+        size_t len = 60 + rng() % 61;
+        for (size_t i = 0; i < len; ++i) s += (char)('0' + rng() % 10);
+        s += '\n';
+    }
+    return padded(std::move(s));
+}
+
+/** Best of kRuns, in MB/s over the whole input */
+template <class F>
+static double runScan(const std::string &input, F scan)
+{
+    double best = 1e30;
+    for (int run = 0; run < kRuns; ++run) {
+        double t0 = nowSeconds();
+        g_sink = scan(input.data(), textSize(input));
+        double t = nowSeconds() - t0;
+        if (t < best) best = t;
+    }
+    return (double)textSize(input) / (1024.0 * 1024.0) / best;
+}
+
+static void benchLines()
+{
+    std::string input = makeLinesInput(64u << 20, 99);
+    std::vector<size_t> starts(input.size() / 60 + 2);
+
+    double tByte = runScan(input, [&](const char *p, size_t n) {
+        size_t lines = 0;
+        for (size_t i = 0; i < n; ++i)
+            if (p[i] == '\n') starts[lines++] = i + 1;
+        return (uint64_t)lines;
+    });
+    double tMemchr = runScan(input, [&](const char *p, size_t n) {
+        size_t lines = 0;
+        const char *end = p + n, *q = p;
+        while ((q = (const char *)memchr(q, '\n', (size_t)(end - q))) != nullptr)
+            starts[lines++] = (size_t)(++q - p);
+        return (uint64_t)lines;
+    });
+    double tIndex = runScan(input, [&](const char *p, size_t n) {
+        return (uint64_t)ffs_index_lines(p, n, starts.data(), starts.size());
+    });
+    double tSkip = runScan(input, [&](const char *p, size_t n) {
+        size_t lines = 0;
+        const char *end = p + n;
+        while ((p = ffs_find_char(p, end, '\n')) < end) { p++; lines++; }
+        return (uint64_t)lines;
+    });
+
+    printf("line-start index, 64 MB of 60-120 byte lines (MB/s, simd = %s)\n",
+           FFS_AVX2 ? "AVX2" : FFS_SSE2 ? "SSE2" : "scalar fallback");
+    printf("%12s %12s %12s %12s\n", "byte loop", "memchr", "index_lines", "find_char");
+    printf("%12.0f %12.0f %12.0f %12.0f\n\n", tByte, tMemchr, tIndex, tSkip);
+}
+
+// -------------------------------------------------------------------------
+// Character classes: <cctype> vs the ffs_ctype table
+// -------------------------------------------------------------------------
+
+/** About 'bytes' of lines in the record format of the test file. */
+static std::string makeRecordsInput(size_t bytes, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string s;
+    s.reserve(bytes + 256);
+    char line[256];
+    for (unsigned long n = 0; s.size() < bytes; ++n) {
+        int len = snprintf(line, sizeof(line),
+            ":%lx[%d]( %d %u %d %x %lx %f %f %s %02d/%02d/%04d %02d:%02d:%02d\n",
+            n, 5, (int)(rng() % 32767), (unsigned)(rng() % 65535), (int)n,
+            (unsigned)(rng() % 65535), (unsigned long)rng(), (double)(rng() % 100000) * 0.1,
+            (double)(rng() % 100000) * 0.01, "token",
+            1, 1, 2020, (int)(n % 24), (int)(n % 60), (int)(n % 60));
+        s.append(line, (size_t)len);
+    }
+    return padded(std::move(s));
+}
+
+static void benchCtype()
+{
+    std::string input = makeRecordsInput(32u << 20, 5);
+
+    // %s-style tokenizing: skip blanks, then run to the next blank
+    double tTokLibc = runScan(input, [](const char *p, size_t n) {
+        const char *end = p + n;
+        uint64_t tokens = 0;
+        while (p < end) {
+            while (p < end && isspace((unsigned char)*p)) p++;
+            if (p == end) break;
+            while (p < end && !isspace((unsigned char)*p)) p++;
+            tokens++;
+        }
+        return tokens;
+    });
+    double tTokTable = runScan(input, [](const char *p, size_t n) {
+        const char *end = p + n;
+        uint64_t tokens = 0;
+        while (p < end) {
+            p = ffs_skip_space(p, end);
+            if (p == end) break;
+            while (p < end && !ffs_is_space(*p)) p++;
+            tokens++;
+        }
+        return tokens;
+    });
+    // per-byte digit / hex digit classification
+    double tClsLibc = runScan(input, [](const char *p, size_t n) {
+        uint64_t digits = 0, hex = 0;
+        for (size_t i = 0; i < n; ++i) {
+            digits += isdigit((unsigned char)p[i]) != 0;
+            hex += isxdigit((unsigned char)p[i]) != 0;
+        }
+        return digits + (hex << 32);
+    });
+    double tClsTable = runScan(input, [](const char *p, size_t n) {
+        uint64_t digits = 0, hex = 0;
+        for (size_t i = 0; i < n; ++i) {
+            digits += ffs_is_digit(p[i]) != 0;
+            hex += ffs_is_xdigit(p[i]) != 0;
+        }
+        return digits + (hex << 32);
+    });
+
+    printf("character classes, 32 MB of records (MB/s)\n");
+    printf("%-22s %12s %12s\n", "", "<cctype>", "ffs_ctype");
+    printf("%-22s %12.0f %12.0f\n", "tokenize (isspace)", tTokLibc, tTokTable);
+    printf("%-22s %12.0f %12.0f\n\n", "isdigit + isxdigit", tClsLibc, tClsTable);
+}
+
+// -------------------------------------------------------------------------
+// Tokens: %s with the byte loop vs ffs_skip_space/ffs_find_space + one copy
+// -------------------------------------------------------------------------
+
+/** Blank-separated tokens of 'len' random letters, about 'bytes' in all. */
+static std::string makeTokensInput(size_t bytes, int len, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string s;
+    s.reserve(bytes + (size_t)len + 2);
+    while (s.size() < bytes) {
+        for (int i = 0; i < len; ++i) s += (char)('a' + rng() % 26);
+        s += (rng() % 8) ? ' ' : '\n';
+    }
+    return padded(std::move(s));
+}
+
+static void benchTokensRow(int len)
+{
+    std::string input = makeTokensInput(32u << 20, len, 11);
+    static char dest[256];
+
+    // the previous readString: NUL written after every character
+    double tLoop = runScan(input, [](const char *p, size_t n) {
+        const char *end = p + n;
+        uint64_t tokens = 0;
+        while (p < end) {
+            while (p < end && ffs_is_space(*p)) p++;
+            int count = 0;
+            while (p < end && !ffs_is_space(*p)) {
+                char c = *p++;
+                if (count < (int)sizeof(dest) - 1) {
+                    dest[count++] = c;
+                    dest[count] = '\0';
+                }
+            }
+            tokens += count > 0;
+        }
+        return tokens + (uint64_t)dest[0];
+    });
+    double tSimd = runScan(input, [](const char *p, size_t n) {
+        const char *end = p + n;
+        uint64_t tokens = 0;
+        while ((p = ffs_skip_space(p, end)) < end) {
+            const char *q = ffs_find_space(p, end);
+            size_t count = (size_t)(q - p);
+            if (count > sizeof(dest) - 1) count = sizeof(dest) - 1;
+            ffs_copy_bytes(dest, p, count);
+            dest[count] = '\0';
+            p = q;
+            tokens++;
+        }
+        return tokens + (uint64_t)dest[0];
+    });
+    printf("%8d %12.0f %12.0f\n", len, tLoop, tSimd);
+}
+
+static void benchTokens()
+{
+    printf("%%s tokens, 32 MB (MB/s, simd = %s)\n",
+           FFS_AVX2 ? "AVX2" : FFS_SSE2 ? "SSE2" : "scalar fallback");
+    printf("%8s %12s %12s\n", "length", "byte loop", "simd+copy");
+    benchTokensRow(5);
+    benchTokensRow(16);
+    benchTokensRow(40);
+    benchTokensRow(120);
+    printf("\n");
+}
+
+// -------------------------------------------------------------------------
+// Conversions: every fast_fscanf_mem specifier and ioRead* function, one
+// field at a time, against sscanf, the strto* family and from_chars
+// -------------------------------------------------------------------------
+
+using Token = std::array<char, 64>;
+
+/** Folds a parsed field into the sink value. */
+template <class T>
+static uint64_t fieldSink(const T &v)
+{
+    if constexpr (std::is_floating_point_v<T>)
+        return (uint64_t)(int64_t)v;
+    else
+        return (uint64_t)v;
+}
+static uint64_t fieldSink(const Token &t) { return (uint8_t)t[0]; }
+static uint64_t fieldSink(const FfsStringView &v) { return v.len + (uint8_t)v.ptr[0]; }
+static uint64_t fieldSink(const data &d) { return (uint64_t)(d.g + d.m + d.a); }
+static uint64_t fieldSink(const ora &o) { return (uint64_t)(o.o + o.m + o.s); }
+
+/** The pointer a scanf-style function takes for a field of type T. */
+template <class T>
+static T *fieldArg(T &v) { return &v; }
+static char *fieldArg(Token &t) { return t.data(); }
+
+// format of the row being measured, for the functions below
+static const char *g_format;            // fast_fscanf_mem
+static const char *g_sscanfFormat;      // the same, ending in %n
+static FfsPlan     *g_plan;             // ffs_compile(g_format)
+
+/** sscanf over fields separated by '\0': glibc's sscanf takes the strlen
+    of its input on every call, which must not cover the whole buffer. */
+template <class... T>
+static bool sscanfParse(const char *&p, const char *, uint64_t &out)
+{
+    std::tuple<T...> v;
+    int n = -1;
+    int got = std::apply([&](T &...f) {
+        return sscanf(p, g_sscanfFormat, fieldArg(f)..., &n);
+    }, v);
+    if (got != (int)sizeof...(T) || n < 0) return false;
+    out = std::apply([](const T &...f) { return (fieldSink(f) + ... + 0); }, v);
+    p += n + 1;
+    return true;
+}
+
+template <class... T>
+static bool ffsMemParse(const char *&p, const char *end, uint64_t &out)
+{
+    std::tuple<T...> v;
+    size_t off = 0;
+    int got = std::apply([&](T &...f) {
+        return fast_fscanf_mem(p, (size_t)(end - p), &off, g_format, fieldArg(f)...);
+    }, v);
+    if (got != (int)sizeof...(T) || off == 0) return false;
+    out = std::apply([](const T &...f) { return (fieldSink(f) + ... + 0); }, v);
+    p += off + 1;
+    return true;
+}
+
+template <class... T>
+static bool ffsPlanParse(const char *&p, const char *end, uint64_t &out)
+{
+    std::tuple<T...> v;
+    size_t off = 0;
+    int got = std::apply([&](T &...f) {
+        return ffs_scan_plan(g_plan, p, (size_t)(end - p), &off, fieldArg(f)...);
+    }, v);
+    if (got != (int)sizeof...(T) || off == 0) return false;
+    out = std::apply([](const T &...f) { return (fieldSink(f) + ... + 0); }, v);
+    p += off + 1;
+    return true;
+}
+
+template <class T, int Base = 10>
+static bool fromCharsAs(const char *&p, const char *end, uint64_t &out)
+{
+    T v;
+    std::from_chars_result r;
+    if constexpr (std::is_floating_point_v<T>)
+        r = std::from_chars(p, end, v, std::chars_format::fixed);
+    else
+        r = std::from_chars(p, end, v, Base);
+    if (r.ec != std::errc()) return false;
+    out = fieldSink(v);
+    p = r.ptr + 1;
+    return true;
+}
+
+static bool strtolParse(const char *&p, const char *, uint64_t &out)
+{
+    char *endp;
+    out = (uint64_t)strtol(p, &endp, 10);
+    if (endp == p) return false;
+    p = endp + 1;
+    return true;
+}
+
+static bool strtoulParse(const char *&p, const char *, uint64_t &out)
+{
+    char *endp;
+    out = strtoul(p, &endp, 10);
+    if (endp == p) return false;
+    p = endp + 1;
+    return true;
+}
+
+static bool strtofParse(const char *&p, const char *, uint64_t &out)
+{
+    char *endp;
+    out = fieldSink(strtof(p, &endp));
+    if (endp == p) return false;
+    p = endp + 1;
+    return true;
+}
+
+/** %s as strcspn + copy, %S as strcspn alone */
+template <bool Copy>
+static bool strcspnParse(const char *&p, const char *, uint64_t &out)
+{
+    static Token dest;
+    size_t n = strcspn(p, " \t\n");
+    if (n == 0) return false;
+    if (Copy) {
+        if (n > dest.size() - 1) n = dest.size() - 1;
+        memcpy(dest.data(), p, n);
+        dest[n] = '\0';
+    }
+    out = n + (uint8_t)p[0];
+    p += n + 1;
+    return true;
+}
+
+static bool memcmpParse(const char *&p, const char *, uint64_t &out)
+{
+    if (memcmp(p, "](", 2) != 0) return false;
+    out = 2;
+    p += 3;
+    return true;
+}
+
+/** "d<Sep>d<Sep>d" with strtol and with from_chars */
+template <char Sep>
+static bool strtolTriple(const char *&p, const char *, uint64_t &out)
+{
+    char *q;
+    long a = strtol(p, &q, 10);
+    if (*q != Sep) return false;
+    long b = strtol(q + 1, &q, 10);
+    if (*q != Sep) return false;
+    long c = strtol(q + 1, &q, 10);
+    out = (uint64_t)(a + b + c);
+    p = q + 1;
+    return true;
+}
+
+template <char Sep>
+static bool fromCharsTriple(const char *&p, const char *end, uint64_t &out)
+{
+    short v[3];
+    for (int i = 0; i < 3; ++i) {
+        auto r = std::from_chars(p, end, v[i]);
+        if (r.ec != std::errc() || (i < 2 && *r.ptr != Sep)) return false;
+        p = r.ptr + 1;
+    }
+    out = (uint64_t)(v[0] + v[1] + v[2]);
+    return true;
+}
+
+/** A memory-mode MyIO over [p, end). */
+static MyIO ioOver(const char *p, const char *end)
+{
+    MyIO io;
+    memset(&io, 0, sizeof(io));
+    io.buffer = io.ptr = const_cast<char *>(p);
+    io.end = const_cast<char *>(end);
+    io.size = (size_t)(end - p);
+    return io;
+}
+
+template <class T, BOOL (*Read)(MyIO *, T *)>
+static bool ioParse(const char *&p, const char *end, uint64_t &out)
+{
+    MyIO io = ioOver(p, end);
+    T v;
+    if (!Read(&io, &v)) return false;
+    out = fieldSink(v);
+    p = io.ptr + 1;
+    return true;
+}
+
+static bool ioTokenParse(const char *&p, const char *end, uint64_t &out)
+{
+    MyIO io = ioOver(p, end);
+    Token t;
+    if (!ioReadToken(&io, t.data(), t.size())) return false;
+    out = fieldSink(t);
+    p = io.ptr + 1;
+    return true;
+}
+
+static bool ioTokenViewParse(const char *&p, const char *end, uint64_t &out)
+{
+    MyIO io = ioOver(p, end);
+    FfsStringView v;
+    if (!ioReadTokenView(&io, &v.ptr, &v.len)) return false;
+    out = fieldSink(v);
+    p = io.ptr + 1;
+    return true;
+}
+
+/** Literals the way read_record_custom matches them: ioReadChar + compare */
+static bool ioLiteralParse(const char *&p, const char *end, uint64_t &out)
+{
+    MyIO io = ioOver(p, end);
+    char c;
+    if (!ioReadChar(&io, &c) || c != ']') return false;
+    if (!ioReadChar(&io, &c) || c != '(') return false;
+    out = 2;
+    p = io.ptr + 1;
+    return true;
+}
+
+typedef bool (*ParseFn)(const char *&p, const char *end, uint64_t &out);
+
+/** One row of the table: a field type, the distribution of its values and
+    the parsers that can read it (nullptr where there is none). */
+struct ConvRow {
+    const char *conv;
+    const char *input;
+    const char *format;         // fast_fscanf_mem, ffs_compile
+    const char *sscanfFormat;
+    int (*field)(std::mt19937_64 &rng, char *buf, const ConvRow &row);
+    int maxDigits;
+    uint64_t maxValue;
+    bool negative;              // half of the values get a '-'
+    ParseFn sscanfFn, libc, fromChars, ffsMem, ffsPlan, ioRead;
+};
+
+static const uint64_t kPow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL,
+};
+
+/** 1..maxDigits digits, the length uniform, no leading zero, at most maxValue */
+static int decimalField(std::mt19937_64 &rng, char *buf, const ConvRow &row)
+{
+    int len = 1 + (int)(rng() % row.maxDigits);
+    uint64_t lo = len == 1 ? 0 : kPow10[len - 1];
+    uint64_t hi = std::min(kPow10[len] - 1, row.maxValue);
+    uint64_t v = lo + rng() % (hi - lo + 1);
+    return snprintf(buf, 32, "%s%llu", row.negative && (rng() & 1) ? "-" : "",
+                    (unsigned long long)v);
+}
+
+static int hexField(std::mt19937_64 &rng, char *buf, const ConvRow &row)
+{
+    static const char hex[] = "0123456789abcdef";
+    int len = 1 + (int)(rng() % row.maxDigits);
+    for (int d = 0; d < len; ++d)
+        buf[d] = hex[d == 0 ? 1 + rng() % 15 : rng() % 16];
+    return len;
+}
+
+/** What create_test_file writes for field_float and field_ldouble */
+static int floatField(std::mt19937_64 &rng, char *buf, const ConvRow &)
+{
+    return snprintf(buf, 32, "%f", (float)((rng() % 10000000) * 0.1));
+}
+
+static int longDoubleField(std::mt19937_64 &rng, char *buf, const ConvRow &)
+{
+    return snprintf(buf, 48, "%Lf", (long double)((rng() % 10000000) * 0.01));
+}
+
+static int tokenField(std::mt19937_64 &rng, char *buf, const ConvRow &row)
+{
+    int len = 1 + (int)(rng() % row.maxDigits);
+    for (int i = 0; i < len; ++i) buf[i] = (char)('a' + rng() % 26);
+    return len;
+}
+
+static int literalField(std::mt19937_64 &, char *buf, const ConvRow &)
+{
+    memcpy(buf, "](", 2);
+    return 2;
+}
+
+static int dateField(std::mt19937_64 &rng, char *buf, const ConvRow &)
+{
+    return snprintf(buf, 32, "%02d/%02d/%04d", 1 + (int)(rng() % 28),
+                    1 + (int)(rng() % 12), 1970 + (int)(rng() % 68));
+}
+
+static int timeField(std::mt19937_64 &rng, char *buf, const ConvRow &)
+{
+    return snprintf(buf, 32, "%02d:%02d:%02d", (int)(rng() % 24),
+                    (int)(rng() % 60), (int)(rng() % 60));
+}
+
+/** 'count' fields of the row, each followed by 'sep' */
+static std::string makeConvInput(const ConvRow &row, size_t count, char sep, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::string s;
+    s.reserve(count * 12);
+    char buf[64];
+    for (size_t i = 0; i < count; ++i) {
+        s.append(buf, (size_t)row.field(rng, buf, row));
+        s += sep;
+    }
+    return padded(std::move(s));
+}
+
+static const ConvRow kConvRows[] = {
+    { "%hd", "1-5 digits, +-", "%hd", "%hd%n", decimalField, 5, 32767, true,
+      sscanfParse<short>, strtolParse, fromCharsAs<short>,
+      ffsMemParse<short>, ffsPlanParse<short>, ioParse<short, ioReadShort> },
+    { "%hu", "1-5 digits", "%hu", "%hu%n", decimalField, 5, 65535, false,
+      sscanfParse<unsigned short>, strtoulParse, fromCharsAs<unsigned short>,
+      ffsMemParse<unsigned short>, ffsPlanParse<unsigned short>,
+      ioParse<unsigned short, ioReadUShort> },
+    { "%d", "1-3 digits, +-", "%d", "%d%n", decimalField, 3, 999, true,
+      sscanfParse<int>, strtolParse, fromCharsAs<int>,
+      ffsMemParse<int>, ffsPlanParse<int>, ioParse<int, ioReadInt> },
+    { "%d", "1-10 digits, +-", "%d", "%d%n", decimalField, 10, INT_MAX, true,
+      sscanfParse<int>, strtolParse, fromCharsAs<int>,
+      ffsMemParse<int>, ffsPlanParse<int>, ioParse<int, ioReadInt> },
+    { "%u", "1-10 digits", "%u", "%u%n", decimalField, 10, UINT_MAX, false,
+      sscanfParse<unsigned>, strtoulParse, fromCharsAs<unsigned>,
+      ffsMemParse<unsigned>, ffsPlanParse<unsigned>, nullptr },
+    { "%hx", "1-4 digits", "%hx", "%hx%n", hexField, 4, 0, false,
+      sscanfParse<unsigned short>, strtoullHexParse, fromCharsAs<unsigned short, 16>,
+      ffsMemParse<unsigned short>, ffsPlanParse<unsigned short>,
+      ioParse<unsigned short, ioReadHexUShort> },
+    { "%lx", "1-16 digits", "%lx", "%lx%n", hexField, 16, 0, false,
+      sscanfParse<unsigned long>, strtoullHexParse, fromCharsAs<unsigned long, 16>,
+      ffsMemParse<unsigned long>, ffsPlanParse<unsigned long>,
+      ioParse<unsigned long, ioReadHexULong> },
+    { "%f", "testdata", "%f", "%f%n", floatField, 0, 0, false,
+      sscanfParse<float>, strtofParse, fromCharsAs<float>,
+      ffsMemParse<float>, ffsPlanParse<float>, ioParse<float, ioReadFloat> },
+    { "%Lf", "testdata", "%Lf", "%Lf%n", longDoubleField, 0, 0, false,
+      sscanfParse<long double>, strtoldParse, fromCharsAs<long double>,
+      ffsMemParse<long double>, ffsPlanParse<long double>,
+      ioParse<long double, ioReadLongDouble> },
+    { "%s", "1-20 letters", "%63s", "%63s%n", tokenField, 20, 0, false,
+      sscanfParse<Token>, strcspnParse<true>, nullptr,
+      ffsMemParse<Token>, ffsPlanParse<Token>, ioTokenParse },
+    { "%S", "1-20 letters", "%S", nullptr, tokenField, 20, 0, false,
+      nullptr, strcspnParse<false>, nullptr,
+      ffsMemParse<FfsStringView>, ffsPlanParse<FfsStringView>, ioTokenViewParse },
+    { "%c", "1 letter", "%c", "%c%n", tokenField, 1, 0, false,
+      sscanfParse<char>, nullptr, nullptr,
+      ffsMemParse<char>, ffsPlanParse<char>, ioParse<char, ioReadChar> },
+    { "](", "literal", "](", "](%n", literalField, 0, 0, false,
+      sscanfParse<>, memcmpParse, nullptr,
+      ffsMemParse<>, ffsPlanParse<>, ioLiteralParse },
+    { "date", "dd/mm/yyyy", "%hd/%hd/%hd", "%hd/%hd/%hd%n", dateField, 0, 0, false,
+      sscanfParse<short, short, short>, strtolTriple<'/'>, fromCharsTriple<'/'>,
+      ffsMemParse<short, short, short>, ffsPlanParse<short, short, short>,
+      ioParse<data, ioReadData> },
+    { "time", "hh:mm:ss", "%hd:%hd:%hd", "%hd:%hd:%hd%n", timeField, 0, 0, false,
+      sscanfParse<short, short, short>, strtolTriple<':'>, fromCharsTriple<':'>,
+      ffsMemParse<short, short, short>, ffsPlanParse<short, short, short>,
+      ioParse<ora, ioReadOra> },
+};
+
+/** ns/field of fn over input, or "-" when there is no such parser */
+static void convCell(const std::string &input, ParseFn fn)
+{
+    if (fn)
+        printf(" %10.2f", runBench(input, kCount, fn));
+    else
+        printf(" %10s", "-");
+}
+
+static void benchConversions()
+{
+    printf("conversions, one field per call (ns/field; libc = strtol/strtoul/strtof/strtold,\n"
+           "strcspn for tokens, memcmp for the literal; sscanf reads '\\0'-separated fields)\n");
+    printf("%-5s %-16s %10s %10s %10s %10s %10s %10s\n",
+           "conv", "input", "sscanf", "libc", "from_chars", "ffs_mem", "ffs_plan", "ioRead");
+    uint64_t seed = 1;
+    for (const ConvRow &row : kConvRows) {
+        std::string input = makeConvInput(row, kCount, ' ', seed);
+        std::string nulInput = makeConvInput(row, kCount, '\0', seed);
+        seed++;
+        g_format = row.format;
+        g_sscanfFormat = row.sscanfFormat;
+        g_plan = ffs_compile(row.format);
+        if (!g_plan) {
+            fprintf(stderr, "ffs_compile failed for %s\n", row.format);
+            exit(1);
+        }
+        printf("%-5s %-16s", row.conv, row.input);
+        convCell(nulInput, row.sscanfFn);
+        convCell(input, row.libc);
+        convCell(input, row.fromChars);
+        convCell(input, row.ffsMem);
+        convCell(input, row.ffsPlan);
+        convCell(input, row.ioRead);
+        printf("\n");
+        fflush(stdout);
+        ffs_free_plan(g_plan);
+    }
+    printf("\n");
+}
+
+int main()
+{
+    benchDecimal();
+    benchHex();
+    benchLongDouble();
+    benchLines();
+    benchCtype();
+    benchTokens();
+    benchConversions();
+    return 0;
+}
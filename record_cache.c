@@ -0,0 +1,239 @@
+/* record_cache.c - binary snapshot of parsed Record arrays
+ *
+ * <file>.rcache is a RecordCacheHeader followed by the Record structs exactly
+ * as they sit in memory, so a later run maps the file (ioMapFile) and uses
+ * the array in place: no text is parsed. The snapshot is keyed by the size,
+ * mtime and a 64-bit content hash of <file>; any mismatch, or a header
+ * written by a build with a different Record layout, makes
+ * record_cache_open fail and record_cache_load rebuild it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "record_cache.h"
+#include "ffs_kernels.h"
+
+#define RECORD_CACHE_MAGIC   "FFSREC1"
+#define RECORD_CACHE_VERSION 1
+
+/* 64 bytes, so the records that follow stay aligned for long double */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;    /* sizeof(Record) ... */
+    uint32_t tokenOffset;   /* ... offsetof(Record, token) ... */
+    uint32_t ldblDigits;    /* ... and LDBL_MANT_DIG of the writer */
+    uint64_t srcSize;
+    int64_t srcMtime;
+    uint64_t srcHash;
+    uint64_t count;
+    uint64_t reserved;
+} RecordCacheHeader;
+
+struct RecordSnapshot {
+    char *base;             /* whole .rcache file */
+    size_t size;
+    BOOL mapped;            /* ioMapFile'd, else malloc'd */
+    const Record *records;
+    size_t count;
+};
+
+/* Size and mtime of a file; FALSE if it cannot be stat'ed */
+static BOOL sourceStamp(const char *filename, uint64_t *size, int64_t *mtime) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(filename, &st) != 0) return FALSE;
+#else
+    struct stat st;
+    if (stat(filename, &st) != 0) return FALSE;
+#endif
+    *size = (uint64_t)st.st_size;
+    *mtime = (int64_t)st.st_mtime;
+    return TRUE;
+}
+
+static uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/* Non-cryptographic 64-bit hash in the style of xxHash64: four independent
+   multiply-rotate lanes over 32-byte stripes, so it runs at several GB/s */
+static uint64_t contentHash(const char *p, size_t n) {
+    const uint64_t P1 = 0x9E3779B185EBCA87ULL, P2 = 0xC2B2AE3D27D4EB4FULL,
+                   P3 = 0x165667B19E3779F9ULL;
+    uint64_t v1 = P1 + P2, v2 = P2, v3 = 0, v4 = 0 - P1;
+    size_t left = n;
+    while (left >= 32) {
+        v1 = rotl64(v1 + ffs_load64(p) * P2, 31) * P1;
+        v2 = rotl64(v2 + ffs_load64(p + 8) * P2, 31) * P1;
+        v3 = rotl64(v3 + ffs_load64(p + 16) * P2, 31) * P1;
+        v4 = rotl64(v4 + ffs_load64(p + 24) * P2, 31) * P1;
+        p += 32;
+        left -= 32;
+    }
+    uint64_t h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18) + (uint64_t)n;
+    for (; left >= 8; left -= 8, p += 8)
+        h = rotl64(h ^ (rotl64(ffs_load64(p) * P2, 31) * P1), 27) * P1 + P3;
+    for (; left > 0; --left, ++p)
+        h = rotl64(h ^ ((unsigned char)*p * P3), 11) * P1;
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* Size, mtime and content hash of the source file */
+static BOOL sourceKey(const char *filename, uint64_t *size, int64_t *mtime, uint64_t *hash) {
+    if (!sourceStamp(filename, size, mtime)) return FALSE;
+    size_t mapped;
+    char *base = ioMapFile(filename, 0, &mapped);
+    if (base) {
+        *hash = contentHash(base, mapped);
+        ioUnmapFile(base, mapped);
+    }
+    else {
+        MyIO io;
+        if (!ioOpen(&io, filename, TRUE)) return FALSE;
+        mapped = io.size;
+        *hash = contentHash(io.buffer, io.size);
+        ioClose(&io);
+    }
+    return mapped == *size;
+}
+
+/* filename + ".rcache" (+ suffix), malloc'd */
+static char *cachePath(const char *filename, const char *suffix) {
+    size_t len = strlen(filename);
+    char *path = (char*)malloc(len + 7 + strlen(suffix) + 1);
+    if (!path) return NULL;
+    memcpy(path, filename, len);
+    strcpy(path + len, ".rcache");
+    strcat(path + len, suffix);
+    return path;
+}
+
+static void headerLayout(RecordCacheHeader *h) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, RECORD_CACHE_MAGIC, sizeof(RECORD_CACHE_MAGIC));
+    h->version = RECORD_CACHE_VERSION;
+    h->recordSize = (uint32_t)sizeof(Record);
+    h->tokenOffset = (uint32_t)offsetof(Record, token);
+    h->ldblDigits = LDBL_MANT_DIG;
+}
+
+/* Writes filename.rcache through a temporary file. Returns TRUE on success */
+BOOL record_cache_write(const char *filename, const Record *records, size_t count) {
+    if (!filename || (!records && count)) return FALSE;
+    RecordCacheHeader hdr;
+    headerLayout(&hdr);
+    if (!sourceKey(filename, &hdr.srcSize, &hdr.srcMtime, &hdr.srcHash)) return FALSE;
+    hdr.count = count;
+
+    char *tmp = cachePath(filename, ".tmp");
+    char *path = cachePath(filename, "");
+    FILE *out = (tmp && path) ? fopen(tmp, "wb") : NULL;
+    BOOL ok = FALSE;
+    if (out) {
+        ok = fwrite(&hdr, sizeof(hdr), 1, out) == 1 &&
+             fwrite(records, sizeof(Record), count, out) == count;
+        ok = (fclose(out) == 0) && ok;
+        if (ok) {
+            remove(path);    /* rename does not replace on Windows */
+            ok = (rename(tmp, path) == 0);
+        }
+        if (!ok) remove(tmp);
+    }
+    free(tmp);
+    free(path);
+    return ok;
+}
+
+/* Maps filename.rcache if its key still matches filename */
+RecordSnapshot *record_cache_open(const char *filename) {
+    if (!filename) return NULL;
+    char *path = cachePath(filename, "");
+    if (!path) return NULL;
+    RecordSnapshot *snap = (RecordSnapshot*)calloc(1, sizeof(RecordSnapshot));
+    if (!snap) {
+        free(path);
+        return NULL;
+    }
+    snap->base = ioMapFile(path, 0, &snap->size);
+    snap->mapped = (snap->base != NULL);
+    if (!snap->base) {
+        MyIO io;
+        if (ioOpen(&io, path, TRUE)) {
+            snap->base = io.buffer;
+            snap->size = io.size;
+        }
+    }
+    free(path);
+
+    RecordCacheHeader want;
+    headerLayout(&want);
+    const RecordCacheHeader *hdr = (const RecordCacheHeader*)snap->base;
+    BOOL ok = snap->base && snap->size >= sizeof(RecordCacheHeader) &&
+              memcmp(hdr, &want, offsetof(RecordCacheHeader, srcSize)) == 0 &&
+              hdr->count <= (snap->size - sizeof(RecordCacheHeader)) / sizeof(Record) &&
+              snap->size == sizeof(RecordCacheHeader) + hdr->count * sizeof(Record);
+    if (ok) {
+        uint64_t size, hash;
+        int64_t mtime;
+        ok = sourceStamp(filename, &size, &mtime) &&
+             size == hdr->srcSize && mtime == hdr->srcMtime &&
+             sourceKey(filename, &size, &mtime, &hash) && hash == hdr->srcHash;
+    }
+    if (!ok) {
+        record_snapshot_close(snap);
+        return NULL;
+    }
+    snap->records = (const Record*)(snap->base + sizeof(RecordCacheHeader));
+    snap->count = (size_t)hdr->count;
+    return snap;
+}
+
+/* Opens the snapshot, parsing filename and writing it first if needed */
+RecordSnapshot *record_cache_load(const char *filename, int threads) {
+    RecordSnapshot *snap = record_cache_open(filename);
+    if (snap) return snap;
+
+    size_t size;
+    char *base = ioMapFile(filename, 0, &size);
+    BOOL mapped = (base != NULL);
+    MyIO io;
+    if (!mapped) {
+        if (!ioOpen(&io, filename, TRUE)) return NULL;
+        base = io.buffer;
+        size = io.size;
+    }
+    Record *records = NULL;
+    unsigned long count = read_records_parallel(base, size, threads, TRUE, &records);
+    BOOL ok = records && record_cache_write(filename, records, count);
+    free(records);
+    if (mapped)
+        ioUnmapFile(base, size);
+    else
+        ioClose(&io);
+    return ok ? record_cache_open(filename) : NULL;
+}
+
+const Record *record_snapshot_records(const RecordSnapshot *snap, size_t *count) {
+    if (count) *count = snap->count;
+    return snap->records;
+}
+
+void record_snapshot_close(RecordSnapshot *snap) {
+    if (!snap) return;
+    if (snap->mapped)
+        ioUnmapFile(snap->base, snap->size);
+    else
+        free(snap->base);
+    free(snap);
+}
@@ -0,0 +1,35 @@
+/* record_cache.h - binary snapshot of parsed Record arrays (<file>.rcache), see record_cache.c */
+#ifndef RECORD_CACHE_H
+#define RECORD_CACHE_H
+
+#include <stddef.h>
+
+#include "fscanfasta.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RecordSnapshot RecordSnapshot;
+
+/* Writes filename.rcache holding records[0 .. count), keyed by the current
+   size, mtime and content hash of filename. Returns TRUE on success */
+BOOL record_cache_write(const char *filename, const Record *records, size_t count);
+
+/* Maps filename.rcache if its key still matches filename.
+   Returns NULL when there is no valid snapshot */
+RecordSnapshot *record_cache_open(const char *filename);
+
+/* record_cache_open, or, when the snapshot is missing or stale, parse
+   filename on 'threads' threads, write the snapshot and open it */
+RecordSnapshot *record_cache_load(const char *filename, int threads);
+
+/* The records of a snapshot (read-only, valid until record_snapshot_close) */
+const Record *record_snapshot_records(const RecordSnapshot *snap, size_t *count);
+void record_snapshot_close(RecordSnapshot *snap);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RECORD_CACHE_H */
@@ -0,0 +1,155 @@
+// record_scan.cpp
+//
+// Record-level glue for the compile-time front-end: the benchmark's record
+// format is a template argument here, so the whole 16-field line becomes one
+// straight-line parser.
+#include <cstdlib>
+#include <cstring>
+
+#include "fscanfasta.h"
+#include "fast_fscanf.h"
+
+extern "C"
+int fast_scan_record(const char *buffer, size_t size, size_t *offset, Record *rec)
+{
+    return fscanfasta::scan<":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %63s "
+                     "%hd/%hd/%hd %hd:%hd:%hd\n">(
+        std::span<const char>(buffer, size), *offset,
+        rec->pn_prog, rec->pn_n,
+        rec->field_short, rec->field_ushort,
+        rec->field_int, rec->field_hexushort, rec->field_hexulong,
+        rec->field_float, rec->field_ldouble,
+        rec->token,
+        rec->day, rec->month, rec->year,
+        rec->hour, rec->minute, rec->second);
+}
+
+extern "C"
+int fast_scan_record_view(const char *buffer, size_t size, size_t *offset, RecordView *rec)
+{
+    FfsStringView token;
+    int n = fscanfasta::scan<":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %S "
+                             "%hd/%hd/%hd %hd:%hd:%hd\n">(
+        std::span<const char>(buffer, size), *offset,
+        rec->pn_prog, rec->pn_n,
+        rec->field_short, rec->field_ushort,
+        rec->field_int, rec->field_hexushort, rec->field_hexulong,
+        rec->field_float, rec->field_ldouble,
+        token,
+        rec->day, rec->month, rec->year,
+        rec->hour, rec->minute, rec->second);
+    if (n > 9) {
+        rec->token = token.ptr;
+        rec->token_len = token.len;
+    }
+    return n;
+}
+
+// -------------------------------------------------------------------------
+// Columnar batches: the same record format, decoded straight into one array
+// per field. The token is not copied: %S gives its position in the buffer.
+// -------------------------------------------------------------------------
+
+namespace {
+
+/** Calls f(column pointer, element size) for every column of cols. */
+template <class F>
+void forEachColumn(RecordColumns &c, F f)
+{
+    f((void **)&c.pn_prog, sizeof(*c.pn_prog));
+    f((void **)&c.pn_n, sizeof(*c.pn_n));
+    f((void **)&c.field_short, sizeof(*c.field_short));
+    f((void **)&c.field_ushort, sizeof(*c.field_ushort));
+    f((void **)&c.field_int, sizeof(*c.field_int));
+    f((void **)&c.field_hexushort, sizeof(*c.field_hexushort));
+    f((void **)&c.field_hexulong, sizeof(*c.field_hexulong));
+    f((void **)&c.field_float, sizeof(*c.field_float));
+    f((void **)&c.field_ldouble, sizeof(*c.field_ldouble));
+    f((void **)&c.token_offset, sizeof(*c.token_offset));
+    f((void **)&c.token_length, sizeof(*c.token_length));
+    f((void **)&c.day, sizeof(*c.day));
+    f((void **)&c.month, sizeof(*c.month));
+    f((void **)&c.year, sizeof(*c.year));
+    f((void **)&c.hour, sizeof(*c.hour));
+    f((void **)&c.minute, sizeof(*c.minute));
+    f((void **)&c.second, sizeof(*c.second));
+}
+
+/** Reallocates every column to 'rows' rows; false (columns unchanged in
+    size) when out of memory. */
+bool growColumns(RecordColumns &c, size_t rows)
+{
+    bool ok = true;
+    forEachColumn(c, [&](void **col, size_t elem) {
+        if (!ok) return;
+        void *p = std::realloc(*col, rows * elem);
+        if (p) *col = p;
+        else ok = false;
+    });
+    if (ok) c.capacity = rows;
+    return ok;
+}
+
+/** Decodes row i of the columns from buffer at offset; on failure offset
+    is left at the start of the record. */
+bool scanRow(std::span<const char> in, size_t &offset, RecordColumns &c, size_t i)
+{
+    size_t off = offset;
+    FfsStringView token;
+    if (fscanfasta::scan<":%lx[%hd]( %hd %hu %d %hx %lx %f %Lf %S "
+                         "%hd/%hd/%hd %hd:%hd:%hd\n">(
+            in, off,
+            c.pn_prog[i], c.pn_n[i],
+            c.field_short[i], c.field_ushort[i],
+            c.field_int[i], c.field_hexushort[i], c.field_hexulong[i],
+            c.field_float[i], c.field_ldouble[i],
+            token,
+            c.day[i], c.month[i], c.year[i],
+            c.hour[i], c.minute[i], c.second[i]) != 16)
+        return false;
+    c.token_offset[i] = (size_t)(token.ptr - in.data());
+    c.token_length[i] = (unsigned int)token.len;
+    offset = off;
+    return true;
+}
+
+} // namespace
+
+extern "C"
+BOOL record_columns_init(RecordColumns *cols, size_t rowGroup)
+{
+    std::memset(cols, 0, sizeof(*cols));
+    cols->rowGroup = rowGroup;
+    if (!growColumns(*cols, rowGroup ? rowGroup : 4096)) {
+        record_columns_free(cols);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+extern "C"
+void record_columns_free(RecordColumns *cols)
+{
+    forEachColumn(*cols, [](void **col, size_t) {
+        std::free(*col);
+        *col = nullptr;
+    });
+    cols->count = cols->capacity = 0;
+}
+
+extern "C"
+size_t read_record_columns(const char *buffer, size_t size, size_t *offset, RecordColumns *cols)
+{
+    std::span<const char> in(buffer, size);
+    size_t limit = cols->rowGroup ? cols->rowGroup : (size_t)-1;
+    size_t rows = 0;
+    while (rows < limit) {
+        if (rows == cols->capacity && !growColumns(*cols, cols->capacity * 2))
+            break;
+        if (!scanRow(in, *offset, *cols, rows))
+            break;
+        rows++;
+    }
+    cols->count = rows;
+    return rows;
+}